@@ -71,6 +71,7 @@
 #include "plain/net/connection/manager.h"
 #include "plain/net/connection/select.h"
 #include "plain/net/packet/basic.h"
+#include "plain/net/packet/pool.h"
 #include "plain/net/socket/api.h"
 #include "plain/net/socket/basic.h"
 #include "plain/net/socket/listener.h"
@@ -0,0 +1,86 @@
+/**
+ * PLAIN FREAMEWORK ( https://github.com/viticm/plain )
+ * $Id mpsc_queue.h
+ * @link https://github.com/viticm/plain for the canonical source repository
+ * @copyright Copyright (c) 2023 viticm( viticm.ti@gmail.com )
+ * @license
+ * @user viticm( viticm.ti@gmail.com )
+ * @date 2024/01/22 11:05
+ * @uses The multi producer single consumer queue(lock free).
+ *       The producers push to a intrusive stack, the consumer take all once
+ *       and reverse it(the first in first out).
+ */
+
+#ifndef PLAIN_BASIC_MPSC_QUEUE_H_
+#define PLAIN_BASIC_MPSC_QUEUE_H_
+
+#include "plain/basic/config.h"
+#include <atomic>
+
+namespace plain {
+
+template <typename T>
+class MpscQueue : noncopyable {
+
+ public:
+  MpscQueue() = default;
+  ~MpscQueue() {
+    clear();
+  }
+
+ public:
+  // Any thread.
+  void push(T value) {
+    auto node =
+      new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(
+      node->next, node,
+      std::memory_order_seq_cst, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Only the consumer thread, return the consumed count.
+  template <typename F>
+  size_t consume(F &&func) {
+    auto node = head_.exchange(nullptr, std::memory_order_seq_cst);
+    Node *first{nullptr};
+    while (node) { // Reverse to the push order.
+      auto next = node->next;
+      node->next = first;
+      first = node;
+      node = next;
+    }
+    size_t r{0};
+    while (first) {
+      std::unique_ptr<Node> current{first};
+      first = first->next;
+      func(std::move(current->value));
+      ++r;
+    }
+    return r;
+  }
+
+  bool empty() const noexcept {
+    return head_.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+  void clear() noexcept {
+    auto node = head_.exchange(nullptr, std::memory_order_acq_rel);
+    while (node) {
+      std::unique_ptr<Node> current{node};
+      node = node->next;
+    }
+  }
+
+ private:
+  struct Node {
+    T value;
+    Node *next;
+  };
+  std::atomic<Node *> head_{nullptr};
+
+};
+
+} // namespace plain
+
+#endif // PLAIN_BASIC_MPSC_QUEUE_H_
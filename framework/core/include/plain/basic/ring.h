@@ -8,14 +8,19 @@
  * @date 2023/04/04 18:40
  * @uses The ring buffer class(lock free).
  *       FixedRing: allocate memory from stack(T buffer[N])
- *       DynamicRing: allocate memory from heap(std::vector<T>)
+ *       DynamicRing: allocate memory from heap(std::vector<T>), the read
+ *                    elements can be borrowed in place(see detach).
  */
 
 #ifndef PLAIN_BASIC_RING_H_
 #define PLAIN_BASIC_RING_H_
 
 #include "plain/basic/config.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <span>
 #include "plain/basic/concepts.h"
 
@@ -104,24 +109,12 @@ using cookie_func_t = std::function<void()>;
 
   std::size_t write(
     const T *buffer, std::size_t count, bool full = false) noexcept {
-    std::size_t available{0};
-	  std::size_t tmp_head{head_.load(std::memory_order_relaxed)};
+    std::size_t available{write_avail()};
     std::size_t to_write{count};
 
-		available = size_ - (tmp_head - tail_.load(index_acquire_barrier));
-
     // Not enough then try resize.
     if (available < count) {
-      auto size = size_.load(std::memory_order_relaxed) << 1;
-      auto avail = size - (tmp_head - tail_.load(index_acquire_barrier));
-      for (uint16_t i = 0; i < 99; ++i) {
-        if (avail >= count) break;
-        size = size << 1;
-        avail = size - (tmp_head - tail_.load(index_acquire_barrier));
-      }
-      if (resize(size)) {
-        available = size_ - (tmp_head - tail_.load(index_acquire_barrier));
-      }
+      if (reserve(count)) available = write_avail();
       if (available < count && full) // must write full.
         return 0;
     }
@@ -129,43 +122,80 @@ using cookie_func_t = std::function<void()>;
 		if (available < count) // do not write more than we can
 			to_write = available;
 
-		// maybe divide it into 2 separate writes
-		for (std::size_t i = 0; i < to_write; i++)
-			buffer_[tmp_head++ & mask_] = buffer[i];
-
-		std::atomic_signal_fence(std::memory_order_release);
-		head_.store(tmp_head, index_release_barrier);
-
-		return to_write;
+    // The free space maybe divide into 2 separate blocks.
+    std::size_t written{0};
+    for (auto block : write_blocks()) {
+      if (written >= to_write) break;
+      auto n = std::min(block.size(), to_write - written);
+      std::copy_n(buffer + written, n, block.data());
+      written += n;
+    }
+    return commit(to_write);
   }
   std::size_t
   read(T *buffer, std::size_t count, bool read_only = false) noexcept {
-    std::size_t available{0};
-    std::size_t tmp_tail{tail_.load(std::memory_order_relaxed)};
+    std::size_t available{read_avail()};
     std::size_t to_read {count};
 
-		available = head_.load(index_acquire_barrier) - tmp_tail;
-
 		if (available < count) // do not read more than we can
 			to_read = available;
 
-		// maybe divide it into 2 separate reads
-		for (std::size_t i = 0; i < to_read; ++i)
-			buffer[i] = buffer_[tmp_tail++ & mask_];
+    // The data maybe divide into 2 separate blocks.
+    std::size_t readed{0};
+    for (auto block : read_blocks()) {
+      if (readed >= to_read) break;
+      auto n = std::min(block.size(), to_read - readed);
+      std::copy_n(block.data(), n, buffer + readed);
+      readed += n;
+    }
 
-		std::atomic_signal_fence(std::memory_order_release);
     // read only not set the tail_.
-    if (!read_only) {
-      if (to_read == available) {
-        head_.store(0, index_release_barrier);
-        tail_.store(0, index_release_barrier);
-      } else {
-        tail_.store(tmp_tail, index_release_barrier);
-      }
-    }
+    if (!read_only) remove(to_read);
 		return to_read;
   }
 
+ public:
+  // Make sure the free space can hold count elements(resize if can).
+  bool reserve(std::size_t count) noexcept {
+    std::size_t used{
+      head_.load(std::memory_order_relaxed) -
+      tail_.load(index_acquire_barrier)};
+    auto size = size_.load(std::memory_order_relaxed);
+    if (size - used >= count) return true;
+    size = size << 1;
+    for (uint16_t i = 0; i < 99; ++i) {
+      if (size - used >= count) break;
+      size = size << 1;
+    }
+    return resize(size);
+  }
+
+  // The contiguous readable blocks, the second is not empty when data wraps.
+  std::array<std::span<T>, 2> read_blocks() const noexcept {
+    std::size_t tmp_tail{tail_.load(std::memory_order_relaxed)};
+    std::size_t available{head_.load(index_acquire_barrier) - tmp_tail};
+    return blocks(tmp_tail, available);
+  }
+
+  // The contiguous writable blocks(write then commit), the second is not
+  // empty when the free space wraps. If count more than the free space then
+  // will try resize the buffer.
+  std::array<std::span<T>, 2> write_blocks(std::size_t count = 0) noexcept {
+    if (count > 0) reserve(count);
+    std::size_t tmp_head{head_.load(std::memory_order_relaxed)};
+    return blocks(tmp_head, write_avail());
+  }
+
+  // Publish the count elements which written by write_blocks.
+  std::size_t commit(std::size_t count) noexcept {
+    std::size_t tmp_head{head_.load(std::memory_order_relaxed)};
+    auto available = write_avail();
+    if (count > available) count = available;
+		std::atomic_signal_fence(std::memory_order_release);
+		head_.store(tmp_head + count, index_release_barrier);
+    return count;
+  }
+
  public:
   std::size_t write_avail() const noexcept {
     return size_ -
@@ -228,18 +258,32 @@ using cookie_func_t = std::function<void()>;
 
  public:
   std::span<const T> read_block() const {
-    return {};
+    return read_blocks()[0];
   }
 
   std::span<T> write_block() const {
-    return {};
+    std::size_t tmp_head{head_.load(std::memory_order_relaxed)};
+    return blocks(tmp_head, write_avail())[0];
   }
   
  protected:
-  void set_buffer(T *buffer, std::size_t size) noexcept {
+  void set_buffer(T *buffer, std::size_t size, std::size_t count = 0) noexcept {
     buffer_ = buffer;
     size_.store(size, std::memory_order_relaxed);
     mask_.store(size - 1, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    head_.store(count, std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<std::span<T>, 2>
+  blocks(std::size_t position, std::size_t count) const noexcept {
+    if (count == 0 || !buffer_) return {};
+    auto size = size_.load(std::memory_order_relaxed);
+    auto index = position & mask_.load(std::memory_order_relaxed);
+    auto first = std::min(count, size - index);
+    return {std::span<T>{buffer_ + index, first},
+            std::span<T>{buffer_, count - first}};
   }
 
  private:
@@ -293,29 +337,52 @@ class DynamicRing : public Ring<T, fake_tso> {
 
  public:
   DynamicRing() {
-   buffer_.resize(SIZE);
-   this->set_buffer(buffer_.data(), SIZE);
+   buffer_ = std::make_shared<std::vector<T>>(SIZE);
+   this->set_buffer(buffer_->data(), SIZE);
   }
   DynamicRing(DynamicRing &&) = default;
   DynamicRing &operator=(DynamicRing &&) = default;
   virtual ~DynamicRing() = default;
 
+ public:
+  // The storage, hold it to borrow the read elements in place(see detach).
+  std::shared_ptr<const std::vector<T>> storage() const noexcept {
+    return buffer_;
+  }
+  // Move the unread to a new storage if the storage still borrowed, so the
+  // writing not overwrite the borrowed(call it before writing).
+  void detach() {
+    if (borrowed(buffer_)) resize(this->size());
+  }
+
  private:
   bool resize(std::size_t size) override {
     std::unique_lock<decltype(mutex_)> auto_lock{mutex_};
-    if (size == 0) {
-      buffer_.clear();
-      size = SIZE;
-    }
-    buffer_.resize(size);
-    this->set_buffer(buffer_.data(), size);
+    if (size == 0) size = SIZE;
+    // The old data will wrapped with the new mask, so move it to the front.
+    // The borrowed one kept as the spare and reused after all released.
+    std::shared_ptr<std::vector<T>> buffer;
+    if (spare_ && spare_->size() == size && !borrowed(spare_))
+      buffer.swap(spare_);
+    else
+      buffer = std::make_shared<std::vector<T>>(size);
+    auto count = this->read(buffer->data(), size, true);
+    buffer_.swap(buffer);
+    this->set_buffer(buffer_->data(), size, count);
+    if (borrowed(buffer)) spare_ = std::move(buffer);
     return true;
   }
+  static bool borrowed(const std::shared_ptr<std::vector<T>> &buffer) {
+    if (buffer.use_count() > 1) return true;
+    // Pair with the borrowers release(the count decrease), then reuse it.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+  }
 
  private:
   std::mutex mutex_; // For resize buffer_
-  std::vector<T> buffer_; // FIXME: C++20: std::vector is constexpr
-                          // 是否可以将FixedRing和DynamicRing做一个整合？
+  std::shared_ptr<std::vector<T>> buffer_;
+  std::shared_ptr<std::vector<T>> spare_; // The borrowed old storage.
 
 };
 
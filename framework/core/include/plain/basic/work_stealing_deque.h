@@ -0,0 +1,158 @@
+/**
+ * PLAIN FREAMEWORK ( https://github.com/viticm/plain )
+ * $Id work_stealing_deque.h
+ * @link https://github.com/viticm/plain for the canonical source repository
+ * @copyright Copyright (c) 2023 viticm( viticm.ti@gmail.com )
+ * @license
+ * @user viticm( viticm.ti@gmail.com )
+ * @date 2024/02/01 10:12
+ * @uses The work stealing deque(Chase-Lev, lock free).
+ *       The owner push and pop the bottom(last in first out), the thieves
+ *       steal the top from any thread. The replaced arrays keep until the
+ *       deque destroyed(a thief may still read them).
+ */
+
+#ifndef PLAIN_BASIC_WORK_STEALING_DEQUE_H_
+#define PLAIN_BASIC_WORK_STEALING_DEQUE_H_
+
+#include "plain/basic/config.h"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include "plain/basic/noncopyable.h"
+
+namespace plain {
+
+template <typename T>
+class WorkStealingDeque : noncopyable {
+
+  static_assert(
+    std::is_trivially_copyable_v<T>, "The deque hold the pointers or values");
+
+ public:
+  explicit WorkStealingDeque(size_t capacity = 256) {
+    size_t size{2};
+    while (size < capacity) size <<= 1;
+    auto array = std::make_unique<Array>(size);
+    array_.store(array.get(), std::memory_order_relaxed);
+    arrays_.emplace_back(std::move(array));
+  }
+  ~WorkStealingDeque() = default;
+
+ public:
+  // Only the owner thread.
+  void push(T value) {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_acquire);
+    auto array = array_.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(array->mask)) array = grow(array, t, b);
+    array->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Only the owner thread.
+  std::optional<T> pop() {
+    auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    auto array = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    std::optional<T> r{array->get(b)};
+    if (t == b) { // The last one, race with the thieves.
+      if (!top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        r = std::nullopt;
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return r;
+  }
+
+  // Any thread, the nullopt when empty or lost the race.
+  std::optional<T> steal() {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return std::nullopt;
+    auto array = array_.load(std::memory_order_acquire);
+    auto r = array->get(t);
+    if (!top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return std::nullopt;
+    return r;
+  }
+
+  // The approximate count when read from the other threads.
+  size_t size() const noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept {
+    return array_.load(std::memory_order_relaxed)->mask + 1;
+  }
+
+  // Only the owner, move to the new array allocated by this thread(the
+  // memory first touched on its numa node).
+  void reallocate() {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_acquire);
+    auto array = array_.load(std::memory_order_relaxed);
+    copy_to(std::make_unique<Array>(array->mask + 1), array, t, b);
+  }
+
+ private:
+  struct Array {
+    size_t mask;
+    std::unique_ptr<std::atomic<T>[]> values;
+    explicit Array(size_t size) :
+      mask{size - 1}, values{std::make_unique<std::atomic<T>[]>(size)} {
+    }
+    T get(int64_t index) const noexcept {
+      return values[static_cast<size_t>(index) & mask].load(
+        std::memory_order_relaxed);
+    }
+    void put(int64_t index, T value) noexcept {
+      values[static_cast<size_t>(index) & mask].store(
+        value, std::memory_order_relaxed);
+    }
+  };
+
+ private:
+  Array *grow(Array *array, int64_t t, int64_t b) {
+    return copy_to(
+      std::make_unique<Array>((array->mask + 1) << 1), array, t, b);
+  }
+
+  Array *copy_to(
+    std::unique_ptr<Array> to, Array *array, int64_t t, int64_t b) {
+    for (auto i = t; i < b; ++i)
+      to->put(i, array->get(i));
+    array = to.get();
+    array_.store(array, std::memory_order_release);
+    arrays_.emplace_back(std::move(to));
+    return array;
+  }
+
+ private:
+  alignas(kCacheInlineAlignment) std::atomic<int64_t> top_{0};
+  alignas(kCacheInlineAlignment) std::atomic<int64_t> bottom_{0};
+  alignas(kCacheInlineAlignment) std::atomic<Array *> array_{nullptr};
+  std::vector<std::unique_ptr<Array>> arrays_; // Only the owner touch.
+
+};
+
+} // namespace plain
+
+#endif // PLAIN_BASIC_WORK_STEALING_DEQUE_H_
@@ -15,6 +15,12 @@
 #include "plain/basic/config.h"
 #include <coroutine>
 
+// The task size(the inline callable buffer and the vtable pointer), the
+// bigger callable spill to the heap. Set it from the cmake plain_task_size.
+#ifndef PLAIN_CONCURRENCY_TASK_SIZE
+#define PLAIN_CONCURRENCY_TASK_SIZE 64
+#endif
+
 namespace plain::concurrency {
 
 namespace executor {
@@ -63,6 +69,24 @@ enum class ResultStatus : int32_t {
   Exception,
 };
 
+// The idle executor worker wait, spin(the cpu pause) and yield before park
+// on the futex. The enqueue not wake the futex when the worker still spin.
+struct wait_policy_t {
+  uint32_t spin_count{0}; // The default park at once.
+  uint32_t yield_count{0};
+};
+
+// About some microseconds spin and yield for the short idle gaps.
+inline constexpr wait_policy_t kAdaptiveWaitPolicy{
+  .spin_count = 4096, .yield_count = 64};
+
+// The built task counts(all threads) for sizing the inline buffer.
+struct task_counters_t {
+  uint64_t inline_count{0};
+  uint64_t heap_count{0}; // The spilled, include the pooled.
+  uint64_t pooled_count{0}; // The spilled and reused the thread freelist.
+};
+
 namespace result {
 
 template <typename T>
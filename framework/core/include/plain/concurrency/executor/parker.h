@@ -0,0 +1,124 @@
+/**
+ * PLAIN FREAMEWORK ( https://github.com/viticm/plain )
+ * $Id parker.h
+ * @link https://github.com/viticm/plain for the canonical source repository
+ * @copyright Copyright (c) 2023 viticm( viticm.ti@gmail.com )
+ * @license
+ * @user viticm( viticm.ti@gmail.com )
+ * @date 2024/02/05 16:20
+ * @uses The executor worker parker(the binary signal).
+ *       The owner spin, yield and then park on the atomic wait by the wait
+ *       policy, the unpark only call the futex when the owner parked.
+ */
+
+#ifndef PLAIN_CONCURRENCY_EXECUTOR_PARKER_H_
+#define PLAIN_CONCURRENCY_EXECUTOR_PARKER_H_
+
+#include "plain/concurrency/executor/config.h"
+#include "plain/sys/atomic_wait.h"
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace plain::concurrency {
+namespace executor {
+namespace detail {
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+class alignas(kCacheInlineAlignment) Parker {
+
+ public:
+  explicit Parker(const wait_policy_t &policy = {}) noexcept :
+    policy_{policy} {
+  }
+
+ public:
+  // Any thread, the signals before the owner take merged to one.
+  void unpark() noexcept {
+    if (state_.exchange(kSignaled, std::memory_order_acq_rel) == kParked)
+      sys::detail::atomic_notify_all(state_);
+  }
+
+  // Only the owner, false when the deadline reached without signal.
+  template <typename Clock, typename Duration>
+  bool park_until(
+    const std::chrono::time_point<Clock, Duration> &deadline) noexcept {
+    if (spin()) return true;
+    while (true) {
+      const auto now = Clock::now();
+      if (now >= deadline) {
+        auto expected = kParked;
+        if (state_.compare_exchange_strong(
+            expected, kEmpty, std::memory_order_acq_rel))
+          return false;
+        state_.store(kEmpty, std::memory_order_relaxed);
+        return true;
+      }
+      const auto ms =
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+      sys::detail::atomic_wait_for(
+        state_, kParked, ms, std::memory_order_acquire);
+      if (state_.load(std::memory_order_acquire) == kSignaled) {
+        state_.store(kEmpty, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+
+  // Only the owner.
+  void park() noexcept {
+    if (spin()) return;
+    sys::detail::atomic_wait(state_, kParked, std::memory_order_acquire);
+    state_.store(kEmpty, std::memory_order_relaxed);
+  }
+
+  const wait_policy_t &policy() const noexcept { return policy_; }
+
+ private:
+  static constexpr int32_t kEmpty{0};
+  static constexpr int32_t kSignaled{1};
+  static constexpr int32_t kParked{2};
+
+ private:
+  bool try_take() noexcept {
+    return state_.load(std::memory_order_relaxed) == kSignaled &&
+      state_.exchange(kEmpty, std::memory_order_acquire) == kSignaled;
+  }
+
+  // True when the signal taken, else the state is parked.
+  bool spin() noexcept {
+    if (try_take()) return true;
+    for (uint32_t i = 0; i < policy_.spin_count; ++i) {
+      cpu_relax();
+      if (try_take()) return true;
+    }
+    for (uint32_t i = 0; i < policy_.yield_count; ++i) {
+      std::this_thread::yield();
+      if (try_take()) return true;
+    }
+    auto expected = kEmpty;
+    if (state_.compare_exchange_strong(
+        expected, kParked, std::memory_order_acq_rel))
+      return false;
+    state_.store(kEmpty, std::memory_order_relaxed); // Signaled.
+    return true;
+  }
+
+ private:
+  std::atomic<int32_t> state_{kEmpty};
+  const wait_policy_t policy_;
+
+};
+
+} // namespace detail
+} // namespace executor
+} // namespace plain::concurrency
+
+#endif // PLAIN_CONCURRENCY_EXECUTOR_PARKER_H_
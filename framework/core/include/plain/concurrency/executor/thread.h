@@ -29,7 +29,8 @@ Thread final : public Derivable<Thread> {
  public:
   Thread(
     const std::function<void(std::string_view name)> &started_callback = {},
-    const std::function<void(std::string_view name)> &terminated_callback = {});
+    const std::function<void(std::string_view name)> &terminated_callback = {},
+    const std::vector<int32_t> &cpus = {});
   ~Thread();
 
  public:
@@ -49,6 +50,7 @@ Thread final : public Derivable<Thread> {
   std::atomic_bool atomic_abort_{false};
   const std::function<void(std::string_view name)> started_callback_;
   const std::function<void(std::string_view name)> terminated_callback_;
+  const std::vector<int32_t> cpus_; // The empty is not pinned.
 
  private:
   void enqueue_impl(std::unique_lock<std::mutex> &lock, Task &task);
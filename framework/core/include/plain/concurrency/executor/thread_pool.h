@@ -7,6 +7,8 @@
  * @user viticm( viticm.ti@gmail.com )
  * @date 2023/09/06 14:41
  * @uses The concurrency thread pool executor implemention.
+ *       Each worker own a work stealing deque, the idle workers steal from
+ *       the busy ones.
  */
 
 #ifndef PLAIN_CONCURRENCY_EXECUTOR_THREAD_POOL_H_
@@ -63,7 +65,9 @@ ThreadPool final : public Derivable<ThreadPool> {
     std::string_view pool_name,
     size_t pool_size, std::chrono::milliseconds max_idle_time,
     const std::function<void(std::string_view name)> &started_callback = {},
-    const std::function<void(std::string_view name)> &terminated_callback = {});
+    const std::function<void(std::string_view name)> &terminated_callback = {},
+    const wait_policy_t &wait_policy = {},
+    const std::vector<int32_t> &cpus = {});
   ~ThreadPool() override;
 
  public:
@@ -76,12 +80,16 @@ ThreadPool final : public Derivable<ThreadPool> {
   void shutdown() override;
 
   std::chrono::milliseconds max_worker_idle_time() const noexcept;
+  const wait_policy_t &wait_policy() const noexcept;
+  // The worker index pinned cpu, -1 is not pinned.
+  int32_t worker_cpu(size_t index) const noexcept;
 
  private:
   friend class detail::ThreadPoolWorker;
 
  private:
   std::vector<detail::ThreadPoolWorker> workers_;
+  const wait_policy_t wait_policy_;
   alignas(kCacheInlineAlignment) std::atomic_size_t round_robin_cursor_;
   alignas(kCacheInlineAlignment) detail::IdleWorkerSet idle_workers_;
   alignas(kCacheInlineAlignment) std::atomic_bool abort_;
@@ -14,9 +14,9 @@
 
 #include "plain/concurrency/executor/config.h"
 #include <mutex>
-#include <semaphore>
 #include "plain/sys/thread.h"
 #include "plain/concurrency/executor/derivable.h"
+#include "plain/concurrency/executor/parker.h"
 
 namespace plain::concurrency {
 namespace executor {
@@ -27,7 +27,9 @@ WorkerThread final : public Derivable<WorkerThread> {
  public:
   WorkerThread(
     const std::function<void(std::string_view)> &started_callback = {},
-    const std::function<void(std::string_view)> &terminated_callback = {});
+    const std::function<void(std::string_view)> &terminated_callback = {},
+    const wait_policy_t &wait_policy = {},
+    const std::vector<int32_t> &cpus = {});
 
  public:
   void enqueue(Task task) override;
@@ -43,12 +45,13 @@ WorkerThread final : public Derivable<WorkerThread> {
   std::atomic_bool private_atomic_abort_;
   alignas(kCacheInlineAlignment) std::mutex lock_;
   std::deque<Task> public_queue_;
-  std::binary_semaphore semaphore_;
+  detail::Parker parker_;
   thread_t thread_;
   std::atomic_bool atomic_abort_;
   bool abort_;
   const std::function<void(std::string_view)> started_callback_;
   const std::function<void(std::string_view)> terminated_callback_;
+  const std::vector<int32_t> cpus_; // The empty is not pinned.
 
  private:
   void make_os_worker_thread();
@@ -0,0 +1,48 @@
+/**
+ * PLAIN FREAMEWORK ( https://github.com/viticm/plain )
+ * $Id frame_pool.h
+ * @link https://github.com/viticm/plain for the canonical source repository
+ * @copyright Copyright (c) 2023 viticm( viticm.ti@gmail.com )
+ * @license
+ * @user viticm( viticm.ti@gmail.com )
+ * @date 2024/02/26 15:20
+ * @uses The coroutine frame pool.
+ *       The frames allocate from the thread size class freelists, the frame
+ *       freed by the other thread return to the owner's(lock free) and the
+ *       owner take them back when its freelist empty.
+ *       The promise types use it when built with the cmake
+ *       plain_with_coroutine_pool(PLAIN_CONCURRENCY_FRAME_POOL).
+ */
+
+#ifndef PLAIN_CONCURRENCY_FRAME_POOL_H_
+#define PLAIN_CONCURRENCY_FRAME_POOL_H_
+
+#include "plain/concurrency/config.h"
+
+namespace plain::concurrency {
+
+namespace detail {
+
+// The bigger frames use the operator new directly.
+inline constexpr size_t kFramePoolMaxSize{2048};
+
+PLAIN_API void *allocate_frame(size_t size);
+PLAIN_API void deallocate_frame(void *ptr, size_t size) noexcept;
+
+// The promise types inherit it(only once in a promise).
+struct pooled_frame {
+#ifdef PLAIN_CONCURRENCY_FRAME_POOL
+  static void *operator new(size_t size) {
+    return allocate_frame(size);
+  }
+  static void operator delete(void *ptr, size_t size) noexcept {
+    deallocate_frame(ptr, size);
+  }
+#endif
+};
+
+} // namespace detail
+
+} // namespace plain::concurrency
+
+#endif // PLAIN_CONCURRENCY_FRAME_POOL_H_
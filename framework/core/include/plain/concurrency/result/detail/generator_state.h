@@ -16,12 +16,13 @@
 #include <cassert>
 #include <exception>
 #include "plain/basic/logger.h"
+#include "plain/concurrency/frame_pool.h"
 
 namespace plain::concurrency {
 namespace result::detail {
 
 template <typename T>
-class GeneratorState {
+class GeneratorState : public concurrency::detail::pooled_frame {
 
  public:
   using value_type = std::remove_reference_t<T>;
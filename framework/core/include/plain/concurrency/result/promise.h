@@ -16,6 +16,7 @@
 #include "plain/concurrency/result/detail/lazy_state.h"
 #include "plain/concurrency/result/detail/state.h"
 #include "plain/concurrency/result/detail/return_value.h"
+#include "plain/concurrency/frame_pool.h"
 
 namespace plain::concurrency {
 namespace result {
@@ -98,7 +99,7 @@ struct initialy_resumed_promise {
   }
 };
 
-struct null_promise {
+struct null_promise : public concurrency::detail::pooled_frame {
   null get_return_object() const noexcept {
     return {};
   }
@@ -124,7 +125,8 @@ struct publisher : public suspend_always {
 };
 
 template <typename T>
-class coroutine_promise : public return_value_struct<coroutine_promise<T>, T> {
+class coroutine_promise : public return_value_struct<coroutine_promise<T>, T>,
+  public concurrency::detail::pooled_frame {
 
  public:
   template <typename ...Args>
@@ -156,7 +158,8 @@ class coroutine_promise : public return_value_struct<coroutine_promise<T>, T> {
 
 template <typename T>
 struct lazy_promise : LazyState<T>, 
-  public return_value_struct<lazy_promise<T>, T> {};
+  public return_value_struct<lazy_promise<T>, T>,
+  public concurrency::detail::pooled_frame {};
 
 struct initialy_resumed_null_result_promise : public initialy_resumed_promise,
   public null_promise {};
@@ -16,16 +16,27 @@
 #include <utility>
 #include <cassert>
 #include "plain/basic/noncopyable.h"
+#include "plain/basic/utility.h"
 
 namespace plain::concurrency {
 
 namespace detail {
 
 struct task_constants {
-  static constexpr size_t total_size = 64;
+  static constexpr size_t total_size = PLAIN_CONCURRENCY_TASK_SIZE;
   static constexpr size_t buffer_size = total_size - sizeof(void *);
 };
 
+static_assert(
+  task_constants::total_size >= 32 &&
+  task_constants::total_size % alignof(std::max_align_t) == 0,
+  "The task size must be aligned and hold a callable pointer at least");
+
+// The spilled callable memory, the small sizes reuse the thread freelist.
+PLAIN_API void *allocate_task(size_t size, size_t align);
+PLAIN_API void deallocate_task(void *ptr, size_t size, size_t align) noexcept;
+PLAIN_API void count_inline_task() noexcept;
+
 struct vtable {
   void (*move_destroy_fn)(void *src, void *dst) noexcept;
   void (*execute_destroy_fn)(void *target);
@@ -55,7 +66,8 @@ class CallableVtable {
  public:
   static constexpr bool is_inlinable() noexcept {
     return std::is_nothrow_move_constructible_v<T> &&
-      sizeof(T) <= task_constants::buffer_size;
+      sizeof(T) <= task_constants::buffer_size &&
+      alignof(T) <= alignof(std::max_align_t);
   }
 
   template <typename CT>
@@ -127,8 +139,10 @@ class CallableVtable {
 
   static void execute_destroy_allocated(void *target) {
     auto callable_ptr = allocated_ptr(target);
+    scoped_executor_t release([callable_ptr]() {
+      free_allocated(callable_ptr);
+    });
     (*callable_ptr)();
-    delete callable_ptr;
   }
 
   static void destroy_inline(void *target) noexcept {
@@ -137,8 +151,12 @@ class CallableVtable {
   }
 
   static void destroy_allocated(void *target) noexcept {
-    auto callable_ptr = allocated_ptr(target);
-    delete callable_ptr;
+    free_allocated(allocated_ptr(target));
+  }
+
+  static void free_allocated(T *callable_ptr) noexcept {
+    callable_ptr->~T();
+    deallocate_task(callable_ptr, sizeof(T), alignof(T));
   }
 
   static constexpr vtable make_vtable() noexcept {
@@ -162,11 +180,19 @@ class CallableVtable {
   template <typename CT>
   static void build_inlinable(void *dst, CT &&callable) {
     new (dst) T(std::forward<CT>(callable));
+    count_inline_task();
   }
 
   template <typename CT>
   static void build_allocated(void *dst, CT &&callable) {
-    auto new_ptr = new T(std::forward<CT>(callable));
+    auto memory = allocate_task(sizeof(T), alignof(T));
+    T *new_ptr{nullptr};
+    try {
+      new_ptr = new (memory) T(std::forward<CT>(callable));
+    } catch (...) {
+      deallocate_task(memory, sizeof(T), alignof(T));
+      throw;
+    }
     new (dst) T*(new_ptr);
   }
 
@@ -177,6 +203,9 @@ class CallableVtable {
 
 } // namespace detail
 
+// The task counts sum of the living and exited threads.
+PLAIN_API task_counters_t task_counters() noexcept;
+
 class PLAIN_API Task {
 
  public:
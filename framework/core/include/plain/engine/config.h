@@ -13,6 +13,7 @@
 #define PLAIN_ENGINE_CONFIG_H_
 
 #include "plain/basic/config.h"
+#include "plain/concurrency/config.h"
 
 namespace plain {
 
@@ -28,14 +29,35 @@ class Kernel;
 class TimerQueue;
 class Timer;
 
+// The timer queue container.
+enum class TimerQueueMode : std::uint8_t {
+  Set = 0, // Ordered by the deadline.
+  Wheel, // Hierarchical timing wheel(add and cancel O(1), fired by the tick).
+};
+
 struct PLAIN_API engine_option {
   size_t max_cpu_threads;
   std::chrono::milliseconds max_thread_pool_executor_waiting_time;
+  concurrency::wait_policy_t thread_pool_wait_policy;
 
   size_t max_background_threads;
   std::chrono::milliseconds max_background_executor_waiting_time;
+  concurrency::wait_policy_t background_wait_policy;
+
+  // The make_worker_thread_executor ones.
+  concurrency::wait_policy_t worker_thread_wait_policy;
+
+  // The cpu ids the executor threads pinned(the pool workers take one each
+  // in turn and allocate the queue on the pinned thread), the empty is not
+  // pinned. The net managers use the setting cpus.
+  std::vector<int32_t> thread_pool_cpus;
+  std::vector<int32_t> background_cpus;
+  std::vector<int32_t> thread_executor_cpus;
+  std::vector<int32_t> worker_thread_cpus;
 
   std::chrono::milliseconds max_timer_queue_waiting_time;
+  TimerQueueMode timer_queue_mode;
+  std::chrono::milliseconds timer_queue_tick; // The wheel tick granularity.
 
   std::function<void(std::string_view thread_name)> thread_started_callback;
   std::function<void(std::string_view thread_name)> thread_terminated_callback;
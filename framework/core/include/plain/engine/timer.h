@@ -22,6 +22,8 @@ namespace plain {
 
 namespace detail {
 
+class TimerWheel;
+
 class PLAIN_API TimerStateBasic :
   public std::enable_shared_from_this<TimerStateBasic> {
 
@@ -92,6 +94,14 @@ class PLAIN_API TimerStateBasic :
   std::atomic_bool cancelled_;
   const bool is_oneshot_;
 
+ private:
+  // The timer wheel links(only the timer queue worker thread).
+  friend class TimerWheel;
+  std::shared_ptr<TimerStateBasic> wheel_next_;
+  TimerStateBasic *wheel_prev_{nullptr};
+  uint64_t wheel_expiry_{0}; // The tick.
+  int32_t wheel_slot_{-1};
+
  private:
   static time_point make_deadline(milliseconds diff) noexcept {
     return clock_type::now() + diff;
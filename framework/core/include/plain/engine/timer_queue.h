@@ -31,13 +31,16 @@ class PLAIN_API TimerQueue : public std::enable_shared_from_this<TimerQueue> {
   TimerQueue(
     std::chrono::milliseconds max_waiting_time,
     const std::function<void(std::string_view name)> &started_callback = {},
-    const std::function<void(std::string_view name)> &terminated_callback = {});
+    const std::function<void(std::string_view name)> &terminated_callback = {},
+    TimerQueueMode mode = TimerQueueMode::Set,
+    std::chrono::milliseconds tick = std::chrono::milliseconds(1));
   ~TimerQueue() noexcept;
 
  public:
   void shutdown();
   bool shutdown_requested() const noexcept;
   std::chrono::milliseconds max_worker_idle_time() const noexcept;
+  TimerQueueMode mode() const noexcept;
 
  public:
   template <typename T, typename ...Args>
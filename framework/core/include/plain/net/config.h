@@ -65,6 +65,7 @@ class Basic;
 namespace packet {
 
 class Basic;
+class Pool;
 
 struct limit_struct {
   uint32_t max_id{kPacketIdMax};
@@ -85,6 +86,45 @@ struct setting_struct {
   std::string address; // listener only
   std::string name;
   packet::limit_t packet_limit;
+  uint32_t packet_pool_size{kPacketPoolSize}; // 0 is disable the pool.
+  // The output block not less than it send with zero copy(io uring SEND_ZC,
+  // the normal send when unsupported), 0 is disabled.
+  uint32_t send_zero_copy_size{kSendZeroCopySize};
+  // The input read until drained or the budget used up once(the others
+  // connections work fairness), 0 is unlimited.
+  uint32_t recv_budget_size{kRecvBudgetSize}; // The bytes.
+  uint32_t recv_budget_count{kRecvBudgetCount}; // The packets handled.
+  // The connection output bytes(not sent) reach the high watermark call the
+  // high callback, then fall to the low call the low callback(the producers
+  // stop and resume sending for the slow peers), 0 is disabled.
+  uint32_t output_high_watermark{0};
+  uint32_t output_low_watermark{0};
+  // The connection no input(or output) in the milliseconds will be removed
+  // and the heartbeat(packet::kHeartbeatId, the default codec only) sent if
+  // no output in the interval. One coarse timer each manager check the
+  // connections active time(the removed one maybe idle a little more), 0 is
+  // disabled.
+  uint32_t read_idle_timeout{0};
+  uint32_t write_idle_timeout{0};
+  uint32_t heartbeat_interval{0};
+  // The rpc calls wait the response each connection, 0 is unlimited.
+  uint32_t rpc_call_max_count{kRpcCallMaxCount};
+  // The rpc packets flushed together sent in one batch frame(the count at
+  // most, the default codec only), the connection received a batch answer
+  // with the batch also(kRpcBatchCount if not set), 0 is disabled.
+  uint32_t rpc_batch_count{0};
+  // Send the rpc method id table(packet::kRpcMethodsId) on connected, the
+  // peers call with the ids after received(the default codec only). The
+  // old peers not know the packet, so enable it when all peers have it.
+  bool rpc_method_ids{false};
+  // Listener only, more than one will start the reactors(each one have the
+  // poll loop and the SO_REUSEPORT listen socket, the connections work in
+  // the reactor which accepted them).
+  uint32_t reactor_count{1};
+  // The cpu ids the manager poll thread and its default worker thread
+  // executor pinned(the reactors take one each in turn), the empty is not
+  // pinned.
+  std::vector<int32_t> cpus;
 };
 
 using setting_t = setting_struct;
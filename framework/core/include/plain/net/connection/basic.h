@@ -13,6 +13,7 @@
 #define PLAIN_NET_CONNECTION_BASIC_H_
 
 #include "plain/net/connection/config.h"
+#include "plain/concurrency/result/basic.h"
 #include "plain/net/packet/basic.h"
 #include "plain/net/stream/codec.h"
 #include "plain/net/rpc/packer.h"
@@ -53,58 +54,55 @@ Basic final : noncopyable {
   void set_dispatcher(packet::dispatch_func func) noexcept;
 
  public:
+  // Queue the packet(the worker encode it), false when the packet is null or
+  // the connection closed. The encode fails on the worker not returned here.
   bool send(const std::shared_ptr<packet::Basic> &packet) noexcept;
+  std::shared_ptr<packet::Basic> new_packet(); // From the manager pool.
+  // The corked connection queue the sent packets(the calls also) and flush
+  // them once uncorked.
+  void cork() noexcept;
+  void uncork() noexcept;
 
  public:
+  size_t input_size() const noexcept; // The bytes buffered.
+  size_t output_size() const noexcept;
+  size_t send_queue_size() const noexcept; // The packets wait for encode.
+  // Not over the output high watermark(the slow peer stop sending).
+  bool writable() const noexcept;
+
+ public:
+  // The call timeout throw std::logic_error(the deadline timer complete it).
   template <typename ...Args>
   rpc::Unpacker call(std::string_view name, Args ...args) {
-    auto future = async_call(name, std::forward<Args>(args)...);
-    if (auto timeout = get_call_timeout()) {
-      auto wait_result = future.wait_for(std::chrono::milliseconds(*timeout));
-      if (wait_result == std::future_status::timeout) {
-        std::string func_name(name.data(), name.size());
-        throw std::logic_error(
-          "call " + func_name + " timeout: " + std::to_string(*timeout));
-      }
-    }
-    return future.get();
+    return async_call(name, std::forward<Args>(args)...).get();
   }
+  // The result can co_await, it completed with the error when timeout, the
+  // connection closed or the calls over setting rpc_call_max_count.
   template <typename ...Args>
-  std::future<rpc::Unpacker> async_call(std::string_view name, Args ...args) {
-    auto packet = std::make_shared<packet::Basic>();
+  concurrency::Result<rpc::Unpacker>
+  async_call(std::string_view name, Args ...args) {
+    auto packet = new_packet();
     packet->set_writeable(true);
     packet->set_id(packet::kRpcRequestId);
     auto args_tuple = std::make_tuple(args...);
     auto index = new_call_index();
     *(packet) << index;
-    *(packet) << name;
+    write_method(*packet, name);
     rpc::Packer packer;
     packer.process(args_tuple);
     *(packet) << packer.vector();
-    
-    auto promise = std::make_shared<std::promise<rpc::Unpacker>>();
-    std::string func_name(name.data(), name.size());
-    auto future = promise->get_future();
-    bool r = send_call(packet, index, func_name, promise);
-    try {
-      if (!r) {
-        throw std::logic_error("async_call " + func_name + " failed");
-      }
-    } catch(...) {
-      promise->set_exception(std::current_exception());
-    }
-    return future;
+    return send_call(packet, index, std::string{name.data(), name.size()});
   }
   void set_call_timeout(const std::chrono::milliseconds &value) noexcept;
   void clear_call_timeout() noexcept;
   template <typename ...Args>
   bool send(std::string_view name, Args ...args) {
-    auto packet = std::make_shared<packet::Basic>();
+    auto packet = new_packet();
     packet->set_writeable(true);
     packet->set_id(packet::kRpcNotifyId);
     packet->set_call_notify(true);
     auto args_tuple = std::make_tuple(args...);
-    *(packet) << name;
+    write_method(*packet, name);
     rpc::Packer packer;
     packer.process(args_tuple);
     *(packet) << packer.vector();
@@ -132,9 +130,20 @@ Basic final : noncopyable {
 
  private:
   void set_id(id_t id) noexcept;
+  int32_t pull(const_byte_span_t bytes) noexcept; // Received to the input.
+  // The zero copy send finished(the result is sent bytes or error).
+  void zero_copy_sent(int32_t result) noexcept;
+  // The packet encoded bytes(the manager codec) shared with the others.
+  bool send_encoded(
+    const std::shared_ptr<packet::Basic> &packet,
+    std::shared_ptr<const bytes_t> bytes) noexcept;
   void set_manager(std::shared_ptr<Manager> manager) noexcept;
   void set_keep_alive(bool flag) const noexcept;
   bool is_keep_alive() const noexcept;
+  bool custom_codec() const noexcept; // The connection set the codec.
+  // The last input or output time(the manager idle clock).
+  void set_active_time(bool input, int64_t time) noexcept;
+  int64_t active_time(bool input) const noexcept;
 
  private:
   bool work() noexcept;
@@ -142,11 +151,12 @@ Basic final : noncopyable {
 
  private:
   bool rpc_dispatch(std::shared_ptr<packet::Basic> packet);
-  bool send_call(
+  concurrency::Result<rpc::Unpacker> send_call(
     const std::shared_ptr<packet::Basic> &packet,
-    uint32_t index, const std::string &func_name,
-    std::shared_ptr<std::promise<rpc::Unpacker>> promise);
+    uint32_t index, std::string func_name);
   uint32_t new_call_index() noexcept;
+  // The method id if the peer sent the table, else the name.
+  void write_method(packet::Basic &packet, std::string_view name) const;
   std::optional<int64_t> get_call_timeout() const noexcept;
 
 };
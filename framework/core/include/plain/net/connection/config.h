@@ -22,6 +22,34 @@ using callable_func = std::function<void(Basic *)>;
 
 static constexpr id_t kInvalidId{-1};
 
+// The manager statistics snapshot(the counters aggregated when read).
+struct stats_struct {
+  uint64_t send_size{0};
+  uint64_t recv_size{0};
+  uint64_t send_packet_count{0};
+  uint64_t recv_packet_count{0};
+  uint64_t recv_copy_size{0};
+  uint64_t decode_error_count{0};
+  uint64_t send_zero_copy_size{0}; // The sent bytes without copy.
+  size_t conn_count{0};
+  size_t work_queue_size{0}; // The connections wait for work.
+  size_t send_queue_size{0}; // The packets wait for encode.
+  size_t input_size{0}; // The bytes buffered.
+  size_t output_size{0};
+  size_t conn_input_size_max{0};
+  size_t conn_output_size_max{0};
+};
+using stats_t = stats_struct;
+
+// The connection buffered and queued sizes.
+struct conn_stats_struct {
+  id_t id{kInvalidId};
+  size_t input_size{0};
+  size_t output_size{0};
+  size_t send_queue_size{0};
+};
+using conn_stats_t = conn_stats_struct;
+
 } // namespace connection
 } // namespace plain::net
 
@@ -34,6 +34,8 @@ Epoll final : public Manager {
   bool sock_add(
     socket::id_t sock_id, connection::id_t conn_id) noexcept override;
   bool sock_remove(socket::id_t sock_id) noexcept override;
+  bool sock_want_write(
+    socket::id_t sock_id, connection::id_t conn_id, bool on) noexcept override;
 
  private:
   struct Impl;
@@ -7,6 +7,9 @@
  * @user viticm( viticm.ti@gmail.com )
  * @date 2024/01/04 17:58
  * @uses The io uring for connection implemention.
+ *       Multishot accept and recv(with the provided buffer ring and the
+ *       registered files), the prepared requests submit once each loop.
+ *       The large output blocks send with SEND_ZC if the kernel support.
  */
 
 #ifndef PLAIN_NET_CONNECTION_IO_URING_H_
@@ -16,6 +19,8 @@
 #include "plain/net/detail/coroutine.h"
 #include "plain/net/connection/manager.h"
 
+struct io_uring_cqe;
+
 namespace plain::net {
 namespace connection {
 
@@ -35,7 +40,9 @@ IoUring final : public Manager {
   bool sock_add(
     socket::id_t sock_id, connection::id_t conn_id) noexcept override;
   bool sock_remove(socket::id_t sock_id) noexcept override;
-  void *get_sock_data() noexcept override;
+  bool send_zero_copy(
+    Basic *conn, const_byte_span_t bytes,
+    std::shared_ptr<const void> owner) noexcept override;
 
  private:
   struct Impl;
@@ -43,7 +50,10 @@ IoUring final : public Manager {
 
  private:
   void handle_input() noexcept;
-  net::detail::Task<int32_t> accept_await() noexcept;
+  void handle_recv(
+    io_uring_cqe *cqe, uint32_t sequence, connection::id_t conn_id) noexcept;
+  void handle_send(
+    io_uring_cqe *cqe, uint32_t sequence, connection::id_t conn_id) noexcept;
 
 };
 
@@ -13,6 +13,7 @@
 #define PLAIN_NET_CONNECTION_MANAGER_H_
 
 #include "plain/net/connection/config.h"
+#include "plain/basic/type/byte.h"
 #include "plain/concurrency/config.h"
 #include "plain/engine/config.h"
 #include "plain/net/packet/config.h"
@@ -41,13 +42,22 @@ class PLAIN_API Manager :
  public:
   void set_codec(const stream::codec_t &codec) noexcept;
   void set_dispatcher(packet::dispatch_func func) noexcept;
+  // Set the handlers before start, the dispatcher used when id not set.
+  void set_handler(packet::id_t id, packet::handler_func func) noexcept;
   void set_connect_callback(callable_func func) noexcept;
   void set_disconnect_callback(callable_func func) noexcept;
+  // The output reach the high watermark or fall to the low(setting).
+  void set_high_watermark_callback(callable_func func) noexcept;
+  void set_low_watermark_callback(callable_func func) noexcept;
 
  public:
   std::shared_ptr<Basic> get_conn(id_t id) const noexcept;
   bool is_full() const noexcept;
+  // Encode once and the connections share the bytes.
   void broadcast(std::shared_ptr<packet::Basic> packet) noexcept;
+  void broadcast(
+    std::shared_ptr<packet::Basic> packet,
+    std::span<const id_t> ids) noexcept; // Only the ids.
   std::shared_ptr<concurrency::executor::Basic> get_executor() const noexcept;
   bool send_ctrl_cmd(std::string_view cmd) noexcept;
   void execute(std::function<void()> func); // Multi safe execute.
@@ -56,6 +66,12 @@ class PLAIN_API Manager :
  public:
   uint64_t send_size() const noexcept;
   uint64_t recv_size() const noexcept;
+  uint64_t recv_packet_count() const noexcept;
+  uint64_t recv_copy_size() const noexcept; // Data copied into recv packets.
+  stats_t stats() const noexcept;
+  std::vector<conn_stats_t> conn_stats() const; // Each connection in use.
+  // The packet pool(nullptr if disabled) with the hit/miss statistics.
+  std::shared_ptr<packet::Pool> packet_pool() const noexcept;
  
  protected:
   virtual bool work() noexcept = 0; // working
@@ -63,12 +79,30 @@ class PLAIN_API Manager :
   virtual bool sock_add(
     socket::id_t sock_id, connection::id_t conn_id) noexcept = 0;
   virtual bool sock_remove(socket::id_t sock_id) noexcept = 0;
+  // Arm(or disarm) the write readiness, the writable socket enqueue the
+  // output work, return false if unsupported(the output work busy again).
+  virtual bool sock_want_write(socket::id_t, connection::id_t, bool) noexcept {
+    return false;
+  }
   std::shared_ptr<Basic> accept() noexcept;
   std::shared_ptr<Basic> accept(socket::id_t sock_id) noexcept;
   virtual bool prepare() noexcept { return true; }
   virtual void *get_sock_data() noexcept { // send/recv need data.
     return nullptr;
   }
+  // Send the output bytes without copy, the connection keep them until
+  // zero_copy_sent, return false to send normally. The owner keep them
+  // until the kernel released(the connection may removed before).
+  virtual bool send_zero_copy(
+    Basic *, const_byte_span_t, std::shared_ptr<const void>) noexcept {
+    return false;
+  }
+  // Work the connections in the worker(poll) thread, set before start.
+  void set_reactor(bool on) noexcept;
+  bool in_worker() const noexcept; // The current thread is the worker.
+  // The coarse milliseconds for the connections active time(the idle check
+  // update it).
+  int64_t idle_clock() const noexcept;
 
  protected:
   std::shared_ptr<Basic> new_conn() noexcept;
@@ -88,10 +122,15 @@ class PLAIN_API Manager :
  protected:
   void increase_send_size(size_t size);
   void increase_recv_size(size_t size);
+  void increase_recv_packet(size_t copy_size) noexcept;
+  void increase_send_packet(size_t count) noexcept;
+  void increase_decode_error() noexcept;
+  void increase_send_zero_copy(size_t size) noexcept;
 
  protected:
   const stream::codec_t &codec() const noexcept;
   const packet::dispatch_func &dispatcher() const noexcept;
+  packet::handler_func handler(packet::id_t id) const noexcept;
   const callable_func &connect_callback() const noexcept;
 
  protected:
@@ -106,6 +145,12 @@ class PLAIN_API Manager :
   friend class net::Listener;
   friend class plain::Kernel;
 
+ private:
+  // The listener reactors, the connection ids begin from base + 1.
+  void set_id_base(id_t base) noexcept;
+  void on_watermark(Basic *conn, bool high) noexcept;
+  void check_idle() noexcept; // Remove the idle and send the heartbeat.
+
  private:
   struct Impl;
   std::unique_ptr<Impl> impl_;
@@ -13,6 +13,7 @@
 #define PLAIN_NET_CONNECTOR_H_
 
 #include "plain/net/config.h"
+#include <span>
 #include "plain/concurrency/config.h"
 #include "plain/net/connection/config.h"
 #include "plain/net/packet/config.h"
@@ -62,8 +63,12 @@ class PLAIN_API Connector final {
   const stream::codec_t &codec() const noexcept;
   void set_dispatcher(packet::dispatch_func func) noexcept;
   const packet::dispatch_func &dispatcher() const noexcept;
+  // Handle the packet id(call once before start), the dispatcher is fallback.
+  void set_handler(packet::id_t id, packet::handler_func func) noexcept;
   void set_connect_callback(connection::callable_func func) noexcept;
   void set_disconnect_callback(connection::callable_func func) noexcept;
+  void set_high_watermark_callback(connection::callable_func func) noexcept;
+  void set_low_watermark_callback(connection::callable_func func) noexcept;
   void set_keep_alive(
 		std::shared_ptr<connection::Basic> conn, bool flag) noexcept;
   bool is_keep_alive(std::shared_ptr<connection::Basic> conn) const noexcept;
@@ -75,12 +80,20 @@ class PLAIN_API Connector final {
   get_conn(connection::id_t id) const noexcept;
   bool is_full() const noexcept;
   void broadcast(std::shared_ptr<packet::Basic> packet) noexcept;
+  void broadcast(
+    std::shared_ptr<packet::Basic> packet,
+    std::span<const connection::id_t> ids) noexcept; // Only the ids.
   std::shared_ptr<concurrency::executor::Basic> get_executor() const noexcept;
   bool running() const noexcept;
 
  public:
   uint64_t send_size() const noexcept;
   uint64_t recv_size() const noexcept;
+  uint64_t recv_packet_count() const noexcept;
+  uint64_t recv_copy_size() const noexcept;
+  connection::stats_t stats() const noexcept;
+  std::vector<connection::conn_stats_t> conn_stats() const;
+  std::shared_ptr<packet::Pool> packet_pool() const noexcept;
 
  private:
   struct Impl;
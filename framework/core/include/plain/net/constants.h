@@ -38,6 +38,15 @@ constexpr Mode kOptimalMode{Mode::Select};
 
 constexpr uint32_t kPacketIdMax{std::numeric_limits<uint16_t>::max()};
 constexpr uint32_t kPacketLengthMax{200 * 1024};
+constexpr uint32_t kPacketPoolSize{1024};
+constexpr uint32_t kPacketPoolCapacityMax{64 * 1024};
+constexpr uint32_t kSendZeroCopySize{64 * 1024};
+constexpr uint32_t kRecvBudgetSize{256 * 1024};
+constexpr uint32_t kRecvBudgetCount{12};
+constexpr uint32_t kIdleCheckIntervalMin{10}; // The milliseconds.
+constexpr uint32_t kIdleCheckIntervalMax{1000};
+constexpr uint32_t kRpcCallMaxCount{4096};
+constexpr uint32_t kRpcBatchCount{64};
 
 constexpr uint32_t kConnectionCountMax{1024};
 constexpr uint32_t kConnectionCountDefault{32};
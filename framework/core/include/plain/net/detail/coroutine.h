@@ -18,6 +18,7 @@
 #include <variant>
 #include <utility>
 #include "plain/concurrency/config.h"
+#include "plain/concurrency/frame_pool.h"
 
 namespace plain::net {
 namespace detail {
@@ -122,7 +123,7 @@ struct Task;
 
 // only for internal usage
 template <typename T, bool nothrow>
-struct TaskPromiseBasic {
+struct TaskPromiseBasic : concurrency::detail::pooled_frame {
   Task<T, nothrow> get_return_object();
   auto initial_suspend() { return std::suspend_never(); }
   auto final_suspend() noexcept {
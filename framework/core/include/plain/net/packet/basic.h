@@ -37,6 +37,19 @@ class PLAIN_API Basic {
   const_byte_span_t data() const noexcept;
   size_t offset() const noexcept;
 
+ public:
+  // Borrow the data from a refcounted buffer(no copy), the owner keep alive
+  // until the packet released or written(copy on write). The copied is the
+  // bytes copied to make the data(as the stream ring to the slab).
+  void set_data(
+    std::shared_ptr<const bytes_t> owner, const_byte_span_t data,
+    size_t copied = 0) noexcept;
+  size_t copied() const noexcept; // The bytes copied into the packet.
+
+ public:
+  void clear() noexcept; // Reset all but keep the data capacity.
+  size_t capacity() const noexcept;
+
  public:
   void set_readable(bool flag) noexcept;
   void set_writeable(bool flag) noexcept;
@@ -20,11 +20,16 @@ namespace packet {
 using dispatch_func = std::function<
   bool(connection::Basic *, std::shared_ptr<Basic>)>;
 using id_t = uint16_t;
+// The packet id handler(the table slot), no shared pointer copy.
+using handler_func = bool (*)(connection::Basic *, Basic &);
 
 static constexpr id_t kMaxId{std::numeric_limits<id_t>::max()};
 static constexpr id_t kRpcRequestId{kMaxId - 1};
 static constexpr id_t kRpcResponseId{kMaxId - 2};
 static constexpr id_t kRpcNotifyId{kMaxId - 3};
+static constexpr id_t kHeartbeatId{kMaxId - 4}; // Dropped if unhandled.
+static constexpr id_t kRpcBatchId{kMaxId - 5};
+static constexpr id_t kRpcMethodsId{kMaxId - 6}; // The method id table.
 
 } // namespace packet
 } // namespace plain::net
@@ -0,0 +1,49 @@
+/**
+ * PLAIN FREAMEWORK ( https://github.com/viticm/plain )
+ * $Id pool.h
+ * @link https://github.com/viticm/plain for the canonical source repository
+ * @copyright Copyright (c) 2023 viticm( viticm.ti@gmail.com )
+ * @license
+ * @user viticm( viticm.ti@gmail.com )
+ * @date 2024/01/18 15:26
+ * @uses The net packet pool class implemention.
+ *       The released packets(and the shared pointer control blocks) back to
+ *       the pool with their data capacity, the next make will reuse them.
+ */
+
+#ifndef PLAIN_NET_PACKET_POOL_H_
+#define PLAIN_NET_PACKET_POOL_H_
+
+#include "plain/net/packet/config.h"
+#include "plain/basic/noncopyable.h"
+
+namespace plain::net {
+namespace packet {
+
+class PLAIN_API Pool : noncopyable {
+
+ public:
+  Pool(
+    size_t max_size = kPacketPoolSize,
+    size_t max_capacity = kPacketPoolCapacityMax);
+  ~Pool();
+
+ public:
+  // Thread safe, the packet can released in any thread.
+  std::shared_ptr<Basic> make();
+
+ public:
+  uint64_t hits() const noexcept;
+  uint64_t misses() const noexcept;
+  size_t size() const noexcept; // The idle packets count.
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl> impl_; // The released packets hold it.
+
+};
+
+} // namespace packet
+} // namespace plain::net
+
+#endif // PLAIN_NET_PACKET_POOL_H_
@@ -13,6 +13,7 @@
 #define PLAIN_NET_RPC_CONFIG_H_
 
 #include "plain/net/config.h"
+#include <unordered_map>
 
 namespace plain::net {
 namespace rpc {
@@ -53,6 +54,17 @@ class Dispatcher;
 class Listener;
 class Connector;
 
+using method_id_t = uint32_t;
+// The name lookup without the string copy.
+struct method_hash {
+  using is_transparent = void;
+  size_t operator()(std::string_view name) const noexcept {
+    return std::hash<std::string_view>{}(name);
+  }
+};
+using method_table_t =
+  std::unordered_map<std::string, method_id_t, method_hash, std::equal_to<>>;
+
 } // namespace rpc
 } // namespace plain::net
 
@@ -39,12 +39,11 @@ class PLAIN_API Dispatcher {
     std::string const &name, F func, tags::void_result const &,
     tags::zero_arg const &) {
     enforce_unique_name(name);
-    funcs_.insert(
-      std::make_pair(name, [func, name](Unpacker &args) {
+    add(name, [func, name](Unpacker &args) {
       //enforce_arg_count(name, 0, args.via.array.size);
       func();
       return std::shared_ptr<Packer>{};
-    }));
+    });
   }
 
   template <typename F>
@@ -54,15 +53,14 @@ class PLAIN_API Dispatcher {
     using args_type = typename func_traits<F>::args_type;
 
     enforce_unique_name(name);
-    funcs_.insert(
-      std::make_pair(name, [func, name](Unpacker &args) {
+    add(name, [func, name](Unpacker &args) {
       constexpr int args_count = std::tuple_size<args_type>::value;
       //enforce_arg_count(name, args_count, args.via.array.size);
       args_type args_real;
       args.unpack(args_real);
       call(func, args_real);
       return std::shared_ptr<Packer>{};
-    }));
+    });
   }
 
   template <typename F>
@@ -71,14 +69,13 @@ class PLAIN_API Dispatcher {
     tags::zero_arg const &) {
 
     enforce_unique_name(name);
-    funcs_.insert(
-      std::make_pair(name, [func, name](Unpacker &args) {
+    add(name, [func, name](Unpacker &args) {
       //enforce_arg_count(name, 0, args.via.array.size);
       auto r = func();
       auto packer = std::make_shared<Packer>();
       packer->process(r);
       return packer;
-    }));
+    });
   }
 
   template <typename F>
@@ -88,8 +85,7 @@ class PLAIN_API Dispatcher {
     using args_type = typename func_traits<F>::args_type;
 
     enforce_unique_name(name);
-    funcs_.insert(
-      std::make_pair(name, [func,name](Unpacker &args) {
+    add(name, [func,name](Unpacker &args) {
       constexpr uint32_t args_count = std::tuple_size<args_type>::value;
       //enforce_arg_count(name, args_count, args.via.array.size);
       args_type args_real;
@@ -98,29 +94,28 @@ class PLAIN_API Dispatcher {
       auto packer = std::make_shared<Packer>();
       packer->process(r);
       return packer;
-    }));
+    });
   }
 
-  void unbind(std::string const &name) {
-    funcs_.erase(name);
-  }
-
-  std::vector<std::string> names() const {
-    std::vector<std::string> names;
-    for(auto it = funcs_.begin(); it != funcs_.end(); ++it)
-      names.push_back(it->first);
-    return names;
-  }
+  void unbind(std::string const &name);
+  std::vector<std::string> names() const;
+  // The method ids assigned at bind(from 1), the peer call with the id after
+  // the table sent on connect.
+  method_id_t method_id(std::string_view name) const noexcept;
+  const method_table_t &methods() const noexcept { return methods_; }
 
  public:
+  // The request have the method name or the id(the name length is 0).
   error_or_t<std::shared_ptr<Packer>>
   dispatch(std::shared_ptr<packet::Basic> packet);
 
  private:
   void enforce_unique_name(const std::string &name);
+  void add(const std::string &name, adaptor_type adaptor);
 
  private:
-  std::unordered_map<std::string, adaptor_type> funcs_;
+  method_table_t methods_;
+  std::vector<adaptor_type> adaptors_; // Index by the method id.
 
 };
 
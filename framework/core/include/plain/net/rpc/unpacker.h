@@ -25,8 +25,17 @@ class PLAIN_API Unpacker {
  public:
   Unpacker();
   Unpacker(const uint8_t *data, size_t size);
+  // The holder keep the data alive(the response packet).
+  Unpacker(
+    std::shared_ptr<const void> holder, const uint8_t *data, size_t size);
+  Unpacker(const Unpacker &) = default;
+  Unpacker(Unpacker &&) noexcept = default;
   ~Unpacker();
 
+ public:
+  Unpacker &operator=(const Unpacker &) = default;
+  Unpacker &operator=(Unpacker &&) noexcept = default;
+
  public:
   Error error_;
 
@@ -226,6 +235,7 @@ class PLAIN_API Unpacker {
  private:
   const uint8_t *data_{nullptr};
   const uint8_t *data_end_{nullptr};
+  std::shared_ptr<const void> holder_;
 
 };
 
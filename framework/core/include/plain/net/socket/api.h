@@ -23,6 +23,7 @@
 #include <sys/socket.h>
 #endif
 #include "plain/basic/error.h"
+#include "plain/basic/type/byte.h"
 
 namespace plain::net {
 namespace socket {
@@ -60,6 +61,10 @@ setsockopt(
 PLAIN_API int32_t
 send(id_t id, const void *buffer, uint32_t length, uint32_t flag);
 
+// Gather write from the buffers(writev), return the total sent size.
+PLAIN_API int32_t
+send(id_t id, std::span<const const_byte_span_t> buffers, uint32_t flag);
+
 PLAIN_API int32_t
 sendto(
   id_t id, const void *buffer, int32_t length, uint32_t flag,
@@ -68,6 +73,10 @@ sendto(
 PLAIN_API int32_t
 recv(id_t id, void *buffer, uint32_t length, uint32_t flag);
 
+// Scatter read into the buffers(readv), return the total received size.
+PLAIN_API int32_t
+recv(id_t id, std::span<const byte_span_t> buffers, uint32_t flag);
+
 PLAIN_API int32_t
 recvfrom(
   id_t id, void *buffer, int32_t length, uint32_t flag,
@@ -14,6 +14,7 @@
 
 #include "plain/net/socket/config.h"
 #include "plain/net/address.h"
+#include "plain/basic/type/byte.h"
 #include "plain/net/detail/coroutine.h"
 
 namespace plain::net {
@@ -42,20 +43,30 @@ class PLAIN_API Basic : noncopyable {
   bool valid() const noexcept;
   bool error() const noexcept;
   int32_t send(const bytes_t &bytes, uint32_t flag = 0);
+  int32_t send(std::span<const const_byte_span_t> buffers, uint32_t flag = 0);
   int32_t recv(bytes_t &bytes, uint32_t flag = 0); // recv max bytes capacity size.
+  int32_t recv(std::span<const byte_span_t> buffers, uint32_t flag = 0);
   size_t avail() const noexcept;
   Type type() const noexcept;
 
  public:
-  virtual detail::Awaitable send_await(
+  detail::Awaitable send_await(
     const bytes_t &bytes, uint32_t flag = 0, void *udata = nullptr) {
+    return send_await(as_const_bytes(bytes), flag, udata);
+  }
+  virtual detail::Awaitable send_await(
+    const_byte_span_t bytes, uint32_t flag = 0, void *udata = nullptr) {
     UNUSED(bytes);
     UNUSED(flag);
     UNUSED(udata);
     return detail::Awaitable{nullptr};
   }
-  virtual detail::Awaitable recv_await(
+  detail::Awaitable recv_await(
     bytes_t &bytes, uint32_t flag = 0, void *udata = nullptr) {
+    return recv_await(byte_span_t{bytes}, flag, udata);
+  }
+  virtual detail::Awaitable recv_await(
+    byte_span_t bytes, uint32_t flag = 0, void *udata = nullptr) {
     UNUSED(bytes);
     UNUSED(flag);
     UNUSED(udata);
@@ -90,6 +101,7 @@ class PLAIN_API Basic : noncopyable {
   uint32_t get_linger() const noexcept;
   bool set_linger(uint32_t lingertime) noexcept;
   bool set_reuse_addr(bool on = true) const noexcept;
+  bool set_reuse_port(bool on = true) const noexcept;
   bool listen(uint32_t backlog);
   int32_t accept(Address &addr);
   int32_t accept();
@@ -29,10 +29,12 @@ IoUring final : public Basic {
   constexpr bool awaitable() const override {
     return true;
   }
+  using Basic::send_await;
+  using Basic::recv_await;
   detail::Awaitable send_await(
-    const bytes_t &bytes, uint32_t flag, void *udata) override;
+    const_byte_span_t bytes, uint32_t flag, void *udata) override;
   detail::Awaitable recv_await(
-    bytes_t &bytes, uint32_t flag, void *udata) override;
+    byte_span_t bytes, uint32_t flag, void *udata) override;
 
  private:
   struct Impl;
@@ -27,7 +27,7 @@ class PLAIN_API Listener : noncopyable {
  public:
   bool init(
     const Address &addr, socket::Type sock_type = socket::Type::Tcp,
-    uint32_t backlog = 5);
+    uint32_t backlog = 5, bool reuse_port = false);
 
  public:
   void close();
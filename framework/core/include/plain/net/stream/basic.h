@@ -13,6 +13,7 @@
 #define PLAIN_NET_STREAM_BASIC_H_
 
 #include "plain/net/stream/config.h"
+#include <array>
 #include "plain/basic/type/byte.h"
 #include "plain/basic/endian.h"
 #include "plain/net/detail/coroutine.h"
@@ -27,8 +28,13 @@ class PLAIN_API Basic : noncopyable {
   virtual ~Basic();
 
  public:
-  int32_t pull() noexcept; // socket -> buffer
+  // socket -> buffer, until drained or the budget(0 is the kRecvBudgetSize)
+  // used up.
+  int32_t pull(size_t budget = 0) noexcept;
+  bool drained() const noexcept; // The last pull read all of the socket.
   int32_t push() noexcept; // buffer -> socket
+  // The bytes received already(the io uring buffer ring) -> buffer.
+  int32_t pull(const_byte_span_t bytes) noexcept;
 
  public:
   detail::Task<int32_t> pull_await(void *udata) noexcept;
@@ -51,11 +57,35 @@ class PLAIN_API Basic : noncopyable {
   size_t write(std::string_view str);
   size_t write(const bytes_t &bytes);
   size_t write(const_byte_span_t bytes);
+  // Append the shared bytes without copy(output only, the push gathers them
+  // in order with the buffer and release when sent), the small copied.
+  bool write(std::shared_ptr<const bytes_t> bytes) noexcept;
   size_t read(std::string &str);
   size_t read(bytes_t &bytes);
   size_t read(std::byte *value, size_t length);
   size_t remove(size_t length) noexcept;
   size_t peek(std::byte *value, size_t length);
+  const_byte_span_t read_block() const noexcept; // The first readable block.
+
+ public:
+  // Reserve the length bytes(two blocks when wraps) for writing in place,
+  // the blocks total size less than length when can't reserve.
+  std::array<byte_span_t, 2> reserve(size_t length) noexcept;
+  size_t commit(size_t length) noexcept; // Publish the reserved written.
+
+ public:
+  // Read the length bytes as a refcounted slice, borrowed from the buffer in
+  // place if contiguous, else copied into a slab(the copied set) which is
+  // reused when all slices of it released.
+  const_byte_span_t
+  read_slice(
+    size_t length, std::shared_ptr<const bytes_t> &owner,
+    size_t *copied = nullptr);
+
+ public:
+  // The decoders make packets from the pool if set.
+  void set_packet_pool(std::shared_ptr<packet::Pool> pool) noexcept;
+  std::shared_ptr<packet::Basic> new_packet();
 
  public:
   template <typename T>
@@ -15,6 +15,7 @@
 #include "plain/net/stream/config.h"
 #include "plain/basic/type/config.h"
 #include "plain/basic/error.h"
+#include <span>
 
 namespace plain::net {
 namespace stream {
@@ -24,10 +25,14 @@ using encode_func =
 using decode_func =
   std::function<error_or_t<std::shared_ptr<packet::Basic>>(
     Basic *input, const packet::limit_t &packet_limit)>;
+// Encode the packet in place into the output stream(reserve and commit).
+using encode_to_func =
+  std::function<bool(Basic *output, const packet::Basic &packet)>;
 
 struct codec_struct {
-  encode_func encode{};
+  encode_func encode{}; // Compatibility, the encode_to is first used.
   decode_func decode{};
+  encode_to_func encode_to{};
 };
 
 using codec_t = codec_struct;
@@ -37,7 +42,19 @@ bytes_t encode(std::shared_ptr<packet::Basic> packet);
 error_or_t<std::shared_ptr<packet::Basic>>
 decode(Basic *input, const packet::limit_t &packet_limit);
 
+bool encode_to(Basic *output, const packet::Basic &packet);
+
+// The rpc batch frame(packet::kRpcBatchId) carry the default encoded packets.
+size_t batch_size(const packet::Basic &packet) noexcept; // The size in batch.
+bool encode_batch_to(
+  Basic *output, std::span<const std::shared_ptr<packet::Basic>> packets);
+// The packets borrow the batch data(new from the input), false if invalid.
+bool decode_batch(
+  Basic *input, const std::shared_ptr<packet::Basic> &batch,
+  const std::function<bool(std::shared_ptr<packet::Basic>)> &func);
+
 bytes_t line_encode(std::shared_ptr<packet::Basic> packet);
+bool line_encode_to(Basic *output, const packet::Basic &packet);
 error_or_t<std::shared_ptr<packet::Basic>>
 line_decode(Basic *input, const packet::limit_t &packet_limit);
 
@@ -87,6 +87,15 @@ PLAIN_API void set_name(const std::string_view &name) noexcept;
 
 PLAIN_API std::uintptr_t get_current_virtual_id() noexcept;
 
+// Pin the current thread to the cpu ids(false when unsupported or invalid).
+PLAIN_API bool set_affinity(const std::vector<int32_t> &cpus) noexcept;
+
+// The cpu ids the current thread can run.
+PLAIN_API std::vector<int32_t> get_affinity() noexcept;
+
+// The numa node of the cpu, -1 is unknown.
+PLAIN_API int32_t numa_node(int32_t cpu) noexcept;
+
 inline const std::string get_id() {
   std::stringstream ss;
   ss << std::this_thread::get_id();
@@ -4,10 +4,11 @@ using plain::concurrency::executor::Thread;
 
 Thread::Thread(
   const std::function<void(std::string_view)> &started_callback,
-  const std::function<void(std::string_view)> &terminated_callback) :
+  const std::function<void(std::string_view)> &terminated_callback,
+  const std::vector<int32_t> &cpus) :
   Derivable<Thread>{"thread"}, abort_{false}, atomic_abort_{false},
   started_callback_{started_callback},
-  terminated_callback_{terminated_callback} {
+  terminated_callback_{terminated_callback}, cpus_{cpus} {
 
 }
 
@@ -22,6 +23,7 @@ void Thread::enqueue_impl(std::unique_lock<std::mutex> &lock, Task &task) {
   new_thread = thread_t(
     [this, self_it = workers_.begin(), task = std::move(task)]() mutable {
     std::string name = detail::make_executor_worker_name(name_);
+    if (!cpus_.empty()) thread::set_affinity(cpus_);
     if (static_cast<bool>(started_callback_)) {
       started_callback_(name);
     }
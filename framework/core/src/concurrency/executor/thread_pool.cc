@@ -1,7 +1,9 @@
 #include "plain/concurrency/executor/thread_pool.h"
-#include <semaphore>
 #include <algorithm>
+#include "plain/basic/utility.h"
 #include "plain/sys/thread.h"
+#include "plain/basic/work_stealing_deque.h"
+#include "plain/concurrency/executor/parker.h"
 
 using plain::concurrency::executor::detail::IdleWorkerSet;
 using plain::concurrency::executor::detail::ThreadPoolWorker;
@@ -39,15 +41,14 @@ class alignas(kCacheInlineAlignment) ThreadPoolWorker {
     ThreadPool &parent_pool, size_t index, size_t pool_size,
     std::chrono::milliseconds max_idle_time,
     const std::function<void(std::string_view)> &started_callback,
-    const std::function<void(std::string_view)> &terminated_callback);
+    const std::function<void(std::string_view)> &terminated_callback,
+    int32_t cpu);
   ThreadPoolWorker(ThreadPoolWorker &&rhs) noexcept;
   ~ThreadPoolWorker() noexcept;
 
  public:
   void enqueue_foreign(Task &task);
   void enqueue_foreign(std::span<Task> tasks);
-  void enqueue_foreign(
-    std::deque<Task>::iterator begin, std::deque<Task>::iterator end);
   void enqueue_foreign(
     std::span<Task>::iterator begin, std::span<Task>::iterator end);
 
@@ -57,11 +58,15 @@ class alignas(kCacheInlineAlignment) ThreadPoolWorker {
   void shutdown();
 
   std::chrono::milliseconds max_worker_idle_time() const noexcept;
-
-  bool appears_empty() const noexcept;
+  int32_t cpu() const noexcept { return cpu_; }
 
  private:
-  std::deque<Task> private_queue_;
+  // The owner pop the last pushed, the idle workers steal the first.
+  WorkStealingDeque<Task *> private_queue_;
+  // The executed tasks reused by the local push(the owner thread only, a
+  // stolen one kept by the thief).
+  std::vector<Task *> free_tasks_;
+  static constexpr size_t kFreeTaskMaxCount{256};
   std::vector<size_t> idle_worker_list_;
   std::atomic_bool atomic_abort_;
   ThreadPool &parent_pool_;
@@ -69,9 +74,13 @@ class alignas(kCacheInlineAlignment) ThreadPoolWorker {
   const size_t pool_size_;
   const std::chrono::milliseconds max_idle_time_;
   const std::string worker_name_;
+  const int32_t cpu_;
+  bool placed_; // The queue reallocated on the pinned thread.
+  uint64_t victim_seed_;
+  std::atomic_bool draining_; // Running the tasks, the public queue waiting.
   alignas(kCacheInlineAlignment) std::mutex lock_;
   std::deque<Task> public_queue_;
-  std::binary_semaphore semaphore_;
+  Parker parker_;
   bool idle_;
   bool abort_;
   std::atomic_bool task_found_or_abort_;
@@ -80,7 +89,14 @@ class alignas(kCacheInlineAlignment) ThreadPoolWorker {
   const std::function<void(std::string_view thread_name)> terminated_callback_;
 
  private:
-  void balance_work();
+  void push_local(Task &task);
+  void free_task(Task *task) noexcept;
+  void wake_thieves(size_t max_count);
+  void notify_steal();
+  bool steal_work();
+  bool steal_foreign(ThreadPoolWorker &thief);
+  bool has_stealable() const noexcept;
+  void clear_private_queue() noexcept;
 
   bool wait_for_task(std::unique_lock<std::mutex> &lock);
   bool drain_queue_impl();
@@ -92,7 +108,6 @@ class alignas(kCacheInlineAlignment) ThreadPoolWorker {
     bool first_enqueuer, std::unique_lock<std::mutex> &lock);
 
 };
-
 } // namespace plain::concurrency::executor::detail
 
 IdleWorkerSet::IdleWorkerSet(size_t size) :
@@ -173,87 +188,131 @@ ThreadPoolWorker::ThreadPoolWorker(
   ThreadPool &parent_pool, size_t index, size_t pool_size,
   std::chrono::milliseconds max_idle_time,
   const std::function<void(std::string_view)> &started_callback,
-  const std::function<void(std::string_view)> &terminated_callback) :
+  const std::function<void(std::string_view)> &terminated_callback,
+  int32_t cpu) :
   atomic_abort_{false}, parent_pool_{parent_pool}, index_{index},
   pool_size_{pool_size}, max_idle_time_{max_idle_time},
   worker_name_{detail::make_executor_worker_name(parent_pool.name_)},
-  semaphore_{0}, idle_{true}, abort_{false}, task_found_or_abort_{false},
+  cpu_{cpu}, placed_{false},
+  victim_seed_{(index + 1) * 0x9e3779b97f4a7c15ull}, draining_{false},
+  parker_{parent_pool.wait_policy()}, idle_{true}, abort_{false},
+  task_found_or_abort_{false},
   started_callback_{started_callback},
   terminated_callback_{terminated_callback} {
+  free_tasks_.reserve(kFreeTaskMaxCount);
   idle_worker_list_.reserve(pool_size);
 
 }
 
 ThreadPoolWorker::ThreadPoolWorker(ThreadPoolWorker &&rhs) noexcept :
   parent_pool_{rhs.parent_pool_}, index_{rhs.index_}, pool_size_{rhs.pool_size_},
-  max_idle_time_{rhs.max_idle_time_}, semaphore_{0}, idle_{true}, abort_{true} {
+  max_idle_time_{rhs.max_idle_time_}, cpu_{rhs.cpu_}, idle_{true},
+  abort_{true} {
   std::abort(); // What not use the delete the move copy construct?
 }
 
 ThreadPoolWorker::~ThreadPoolWorker() noexcept {
   assert(idle_);
   assert(!thread_.joinable());
+  clear_private_queue();
 }
 
-void ThreadPoolWorker::balance_work() {
-  const auto task_count = private_queue_.size();
-  if (task_count < 2) return;
-  const auto max_idle_worker_count = std::min(pool_size_ - 1, task_count - 1);
-  if (max_idle_worker_count == 0) return;
-  parent_pool_.find_idle_workers(
-    index_, idle_worker_list_, max_idle_worker_count);
-  const auto idle_count = idle_worker_list_.size();
-  if (idle_count == 0) return;
+void ThreadPoolWorker::push_local(Task &task) {
+  if (free_tasks_.empty()) {
+    private_queue_.push(new Task{std::move(task)});
+    return;
+  }
+  auto free_task = free_tasks_.back();
+  free_tasks_.pop_back();
+  *free_task = std::move(task);
+  private_queue_.push(free_task);
+}
 
-  assert(idle_count <= task_count);
-  const auto total_worker_count = (idle_count + 1);
-  const auto donation_count = task_count / total_worker_count;
-  auto extra = task_count - donation_count * total_worker_count;
-  
-  size_t begin{0};
-  size_t end{donation_count};
+void ThreadPoolWorker::free_task(Task *task) noexcept {
+  if (free_tasks_.size() >= kFreeTaskMaxCount) {
+    delete task;
+    return;
+  }
+  task->clear();
+  free_tasks_.emplace_back(task);
+}
 
+// Let the idle workers steal, the waked one active before the notify.
+void ThreadPoolWorker::wake_thieves(size_t max_count) {
+  max_count = std::min(max_count, pool_size_ - 1);
+  if (max_count == 0) return;
+  // Pair with the fence in wait_for_task, the pushed seen or the idle seen.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  parent_pool_.find_idle_workers(index_, idle_worker_list_, max_count);
   for (const auto idle_worker_index : idle_worker_list_) {
     assert(idle_worker_index != index_);
-    assert(idle_worker_index < pool_size_);
-    assert(begin < task_count);
+    parent_pool_.worker_at(idle_worker_index).notify_steal();
+  }
+  idle_worker_list_.clear();
+}
 
-    if (extra != 0) {
-      ++end;
-      --extra;
+void ThreadPoolWorker::notify_steal() {
+  std::unique_lock<decltype(lock_)> lock{lock_};
+  if (abort_) return;
+  task_found_or_abort_.store(true, std::memory_order_relaxed);
+  ensure_worker_active(true, lock);
+}
+
+// Steal one from the others' deques(a random victim first), then half of
+// the public queue.
+bool ThreadPoolWorker::steal_work() {
+  if (pool_size_ < 2) return false;
+  victim_seed_ ^= victim_seed_ << 13;
+  victim_seed_ ^= victim_seed_ >> 7;
+  victim_seed_ ^= victim_seed_ << 17;
+  const auto start = static_cast<size_t>(victim_seed_ % pool_size_);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    const auto index = (start + i) % pool_size_;
+    if (index == index_) continue;
+    auto &victim = parent_pool_.worker_at(index);
+    if (auto task = victim.private_queue_.steal()) {
+      private_queue_.push(*task);
+      if (victim.private_queue_.size() > 1) wake_thieves(1);
+      return true;
     }
-    assert(end <= task_count);
-
-    auto donation_begin_it = private_queue_.begin() + begin;
-    auto donation_end_it = private_queue_.begin() + end;
-
-    assert(donation_begin_it < private_queue_.end());
-    assert(donation_end_it <= private_queue_.end());
-
-    parent_pool_.worker_at(idle_worker_index).enqueue_foreign(
-      donation_begin_it, donation_end_it);
-
-    begin = end;
-    end += donation_count;
   }
+  for (size_t i = 0; i < pool_size_; ++i) {
+    const auto index = (start + i) % pool_size_;
+    if (index == index_) continue;
+    if (parent_pool_.worker_at(index).steal_foreign(*this))
+      return true;
+  }
+  return false;
+}
 
-  assert(private_queue_.size() == task_count);
-
-  assert(std::all_of(
-    private_queue_.begin(), private_queue_.begin() + begin, [](auto &task) {
-    return !static_cast<bool>(task);
-  }));
-
-  assert(std::all_of(
-    private_queue_.begin() + begin, private_queue_.end(), [](auto &task) {
-    return static_cast<bool>(task);
-  }));
+// Only from the busy one, the waking one will take its own soon.
+bool ThreadPoolWorker::steal_foreign(ThreadPoolWorker &thief) {
+  if (!draining_.load(std::memory_order_relaxed)) return false;
+  std::unique_lock<decltype(lock_)> lock{lock_, std::try_to_lock};
+  if (!lock.owns_lock() || abort_ || public_queue_.empty())
+    return false;
+  const auto count = (public_queue_.size() + 1) / 2;
+  for (size_t i = 0; i < count; ++i) {
+    thief.push_local(public_queue_.front());
+    public_queue_.pop_front();
+  }
+  return true;
+}
 
-  private_queue_.erase(private_queue_.begin(), private_queue_.begin() + begin);
-  
-  assert(!private_queue_.empty());
+bool ThreadPoolWorker::has_stealable() const noexcept {
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (i == index_) continue;
+    if (!parent_pool_.worker_at(i).private_queue_.empty()) return true;
+  }
+  return false;
+}
 
-  idle_worker_list_.clear();
+void ThreadPoolWorker::clear_private_queue() noexcept {
+  while (auto task = private_queue_.pop())
+    delete *task;
+  for (auto task : free_tasks_)
+    delete task;
+  free_tasks_.clear();
 }
 
 bool ThreadPoolWorker::wait_for_task(std::unique_lock<std::mutex> &lock) {
@@ -266,25 +325,25 @@ bool ThreadPoolWorker::wait_for_task(std::unique_lock<std::mutex> &lock) {
 
   parent_pool_.mark_worker_idle(index_);
 
+  // Pair with the fence in wake_thieves.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (has_stealable()) {
+    parent_pool_.mark_worker_active(index_);
+    lock.lock();
+    return true;
+  }
+
   auto event_found = false;
   const auto deadline = std::chrono::steady_clock::now() + max_idle_time_;
 
   while (true) {
-    if (!semaphore_.try_acquire_until(deadline)) {
-      if (std::chrono::steady_clock::now() <= deadline)
-        continue;
-      else
-        break;
-    }
+    if (!parker_.park_until(deadline))
+      break;
     if (!task_found_or_abort_.load(std::memory_order_relaxed)) {
       continue;
     }
+    // The new task or the steal notify.
     lock.lock();
-    if (public_queue_.empty() && !abort_) {
-      lock.unlock();
-      continue;
-    }
-
     event_found = true;
     break;
   }
@@ -296,42 +355,41 @@ bool ThreadPoolWorker::wait_for_task(std::unique_lock<std::mutex> &lock) {
     lock.unlock();
     return false;
   }
-  assert(!public_queue_.empty());
   parent_pool_.mark_worker_active(index_);
   return true;
 }
 
 bool ThreadPoolWorker::drain_queue_impl() {
-  auto aborted = false;
-
-  while (!private_queue_.empty()) {
-    balance_work();
-    
+  draining_.store(true, std::memory_order_relaxed);
+  while (auto task = private_queue_.pop()) {
+    auto current = *task;
+    scoped_executor_t release([this, current] { free_task(current); });
     if (atomic_abort_.load(std::memory_order_relaxed)) {
-      aborted = true;
-      break;
+      draining_.store(false, std::memory_order_relaxed);
+      std::unique_lock<decltype(lock_)> lock{lock_};
+      idle_ = true;
+      return false;
     }
-
-    assert(!private_queue_.empty());
-    auto task = std::move(private_queue_.back());
-    private_queue_.pop_back();
-    task();
-  }
-
-  if (aborted) {
-    std::unique_lock<decltype(lock_)> lock{lock_};
-    idle_ = true;
-    return false;
+    (*current)();
   }
+  draining_.store(false, std::memory_order_relaxed);
   return true;
 }
 
 bool ThreadPoolWorker::drain_queue() {
-  std::unique_lock<decltype(lock_)> lock{lock_};
-  if (!wait_for_task(lock))
+  if (!drain_queue_impl())
     return false;
+
+  std::unique_lock<decltype(lock_)> lock{lock_};
+  if (public_queue_.empty() && !abort_) {
+    lock.unlock();
+    if (steal_work())
+      return true;
+    lock.lock();
+    if (!wait_for_task(lock))
+      return false;
+  }
   assert(lock.owns_lock());
-  assert(!public_queue_.empty() || abort_);
 
   task_found_or_abort_.store(false, std::memory_order_relaxed);
 
@@ -339,11 +397,16 @@ bool ThreadPoolWorker::drain_queue() {
     idle_ = true;
     return false;
   }
-  assert(private_queue_.empty());
-  std::swap(private_queue_, public_queue_);
+  if (public_queue_.empty()) // Waked to steal.
+    return true;
+  std::deque<Task> public_queue;
+  std::swap(public_queue, public_queue_);
   lock.unlock();
 
-  return drain_queue_impl();
+  for (auto &task : public_queue)
+    push_local(task);
+  wake_thieves(public_queue.size() - 1);
+  return true;
 }
 
 void ThreadPoolWorker::work_loop() {
@@ -355,6 +418,7 @@ void ThreadPoolWorker::work_loop() {
         return;
     }
   } catch (const std::runtime_error &) {
+    draining_.store(false, std::memory_order_relaxed);
     std::unique_lock<decltype(lock_)> lock{lock_};
     idle_ = true;
   }
@@ -367,12 +431,17 @@ void ThreadPoolWorker::ensure_worker_active(
   if (!idle_) {
     lock.unlock();
     if (first_enqueuer)
-      semaphore_.release();
+      parker_.unpark();
     return;
   }
   auto stale_worker = std::move(thread_);
   thread_ = thread_t([this]{
     thread::set_name(worker_name_);
+    if (cpu_ != -1 && thread::set_affinity({cpu_}) && !placed_) {
+      // Only the known node worth the first touch.
+      if (thread::numa_node(cpu_) != -1) private_queue_.reallocate();
+      placed_ = true;
+    }
     if (static_cast<bool>(started_callback_))
       started_callback_(worker_name_);
     work_loop();
@@ -410,21 +479,6 @@ void ThreadPoolWorker::enqueue_foreign(std::span<Task> tasks) {
   ensure_worker_active(is_empty, lock);
 }
 
-void ThreadPoolWorker::enqueue_foreign(
-  std::deque<Task>::iterator begin, std::deque<Task>::iterator end) {
-  std::unique_lock<decltype(lock_)> lock{lock_};
-  if (abort_)
-    throw_runtime_shutdown_exception(parent_pool_.name_);
-
-  task_found_or_abort_.store(true, std::memory_order_relaxed);
-
-  const auto is_empty = public_queue_.empty();
-  public_queue_.insert(
-    public_queue_.end(), std::make_move_iterator(begin),
-    std::make_move_iterator(end));
-  ensure_worker_active(is_empty, lock);
-}
-
 void ThreadPoolWorker::enqueue_foreign(
   std::span<Task>::iterator begin, std::span<Task>::iterator end) {
   std::unique_lock<decltype(lock_)> lock{lock_};
@@ -440,19 +494,22 @@ void ThreadPoolWorker::enqueue_foreign(
   ensure_worker_active(is_empty, lock);
 }
 
+// The single one keep on self(the owner pop it next), more let the idle
+// workers steal.
 void ThreadPoolWorker::enqueue_local(Task &task) {
   if (atomic_abort_.load(std::memory_order_relaxed))
     throw_runtime_shutdown_exception(parent_pool_.name_);
 
-  private_queue_.emplace_back(std::move(task));
+  push_local(task);
+  if (private_queue_.size() > 1) wake_thieves(1);
 }
 
 void ThreadPoolWorker::enqueue_local(std::span<Task> tasks) {
-   if (atomic_abort_.load(std::memory_order_relaxed))
+  if (atomic_abort_.load(std::memory_order_relaxed))
     throw_runtime_shutdown_exception(parent_pool_.name_);
-  private_queue_.insert(
-    private_queue_.end(), std::make_move_iterator(tasks.begin()),
-    std::make_move_iterator(tasks.end())); 
+  for (auto &task : tasks)
+    push_local(task);
+  if (private_queue_.size() > 1) wake_thieves(private_queue_.size() - 1);
 }
 
 void ThreadPoolWorker::shutdown() {
@@ -466,22 +523,20 @@ void ThreadPoolWorker::shutdown() {
 
   task_found_or_abort_.store(true, std::memory_order_relaxed);
   
-  semaphore_.release();
+  parker_.unpark();
 
   if (thread_.joinable()) {
     thread_.join();
   }
 
   decltype(public_queue_) public_queue;
-  decltype(private_queue_) private_queue;
 
   {
     std::unique_lock<decltype(lock_)> lock{lock_};
     public_queue = std::move(public_queue_);
-    private_queue = std::move(private_queue_);
   }
   public_queue.clear();
-  private_queue.clear();
+  clear_private_queue(); // The other workers may still steal, it is safe.
 }
 
 std::chrono::milliseconds
@@ -489,22 +544,21 @@ ThreadPoolWorker::max_worker_idle_time() const noexcept {
   return max_idle_time_;
 }
 
-bool ThreadPoolWorker::appears_empty() const noexcept {
-  return private_queue_.empty() &&
-    !task_found_or_abort_.load(std::memory_order_relaxed);
-}
-
 
 ThreadPool::ThreadPool(
   std::string_view name, size_t size, std::chrono::milliseconds max_idle_time,
   const std::function<void(std::string_view)> &started_callback,
-  const std::function<void(std::string_view)> &terminated_callback) :
-  Derivable<ThreadPool>{name}, round_robin_cursor_{0}, idle_workers_{size},
-  abort_{false} {
+  const std::function<void(std::string_view)> &terminated_callback,
+  const wait_policy_t &wait_policy, const std::vector<int32_t> &cpus) :
+  Derivable<ThreadPool>{name}, wait_policy_{wait_policy},
+  round_robin_cursor_{0}, idle_workers_{size}, abort_{false} {
   workers_.reserve(size);
   for (size_t i = 0; i < size; ++i) {
+    // The workers take the cpus in turn.
+    const auto cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
     workers_.emplace_back(
-      *this, i, size, max_idle_time, started_callback, terminated_callback);
+      *this, i, size, max_idle_time, started_callback, terminated_callback,
+      cpu);
     idle_workers_.set_idle(i);
   }
 }
@@ -533,16 +587,14 @@ void ThreadPool::mark_worker_active(size_t index) noexcept {
 
 void ThreadPool::enqueue(Task task) {
   const auto this_worker = detail::s_tl_thread_pool_data.this_worker;
-  const auto this_worker_index = detail::s_tl_thread_pool_data.this_thread_index;
-  if (this_worker != nullptr && this_worker->appears_empty()) {
+  if (this_worker != nullptr) {
     return this_worker->enqueue_local(task);
   }
 
-  const auto idle_worker_pos = idle_workers_.find_idle_worker(this_worker_index);
+  const auto idle_worker_pos =
+    idle_workers_.find_idle_worker(static_cast<size_t>(-1));
   if (idle_worker_pos != static_cast<size_t>(-1))
     return workers_[idle_worker_pos].enqueue_foreign(task);
-  if (this_worker != nullptr)
-    return this_worker->enqueue_local(task);
 
   const auto next_worker = round_robin_cursor_.fetch_add(
     1, std::memory_order_relaxed) % workers_.size();
@@ -607,3 +659,12 @@ void ThreadPool::shutdown() {
 std::chrono::milliseconds ThreadPool::max_worker_idle_time() const noexcept {
   return workers_[0].max_worker_idle_time();
 }
+
+const plain::concurrency::wait_policy_t &
+ThreadPool::wait_policy() const noexcept {
+  return wait_policy_;
+}
+
+int32_t ThreadPool::worker_cpu(size_t index) const noexcept {
+  return index < workers_.size() ? workers_[index].cpu() : -1;
+}
@@ -14,11 +14,12 @@ using plain::concurrency::executor::WorkerThread;
 
 WorkerThread::WorkerThread(
   const std::function<void(std::string_view)> &started_callback,
-  const std::function<void(std::string_view)> &terminated_callback) :
+  const std::function<void(std::string_view)> &terminated_callback,
+  const wait_policy_t &wait_policy, const std::vector<int32_t> &cpus) :
   Derivable<WorkerThread>{"worker thread"}, private_atomic_abort_{false},
-  semaphore_{0}, abort_{false},
+  parker_{wait_policy}, abort_{false},
   started_callback_{started_callback},
-  terminated_callback_{terminated_callback} {
+  terminated_callback_{terminated_callback}, cpus_{cpus} {
 
 }
 
@@ -26,6 +27,7 @@ void WorkerThread::make_os_worker_thread() {
   thread_ = thread_t([this]{
     auto name = detail::make_executor_worker_name(name_);
     thread::set_name(name);
+    if (!cpus_.empty()) thread::set_affinity(cpus_);
     if (static_cast<bool>(started_callback_))
       started_callback_(name);
     work_loop();
@@ -54,7 +56,7 @@ void WorkerThread::wait_for_task(std::unique_lock<std::mutex> &lock) {
   while (true) {
     lock.unlock();
 
-    semaphore_.acquire();
+    parker_.park();
     lock.lock();
 
     if (!public_queue_.empty() || abort_)
@@ -114,7 +116,7 @@ void WorkerThread::enqueue_foreign(Task &task) {
 
   lock.unlock();
   if (is_empty)
-    semaphore_.release();
+    parker_.unpark();
 }
 
 void WorkerThread::enqueue_foreign(std::span<Task> tasks) {
@@ -132,7 +134,7 @@ void WorkerThread::enqueue_foreign(std::span<Task> tasks) {
 
   lock.unlock();
   if (is_empty)
-    semaphore_.release();
+    parker_.unpark();
 }
 
 void WorkerThread::enqueue(Task task) {
@@ -166,7 +168,7 @@ void WorkerThread::shutdown() {
     abort_ = true;
   }
   private_atomic_abort_.store(true, std::memory_order_relaxed);
-  semaphore_.release();
+  parker_.unpark();
 
   if (thread_.joinable())
     thread_.join();
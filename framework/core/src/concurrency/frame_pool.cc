@@ -0,0 +1,179 @@
+#include "plain/concurrency/frame_pool.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace plain::concurrency::detail {
+
+namespace {
+
+// The size classes include the header.
+constexpr size_t kFrameSizeClasses[]{
+  64, 128, 256, 512, 1024, kFramePoolMaxSize};
+constexpr size_t kFrameSizeClassCount{std::size(kFrameSizeClasses)};
+constexpr size_t kFrameFreeMaxCount{1024}; // Each size class keep at most.
+
+struct FrameCache;
+
+// The pooled block header before the frame.
+struct alignas(std::max_align_t) frame_header_t {
+  FrameCache *owner; // The null when allocated after the thread exited.
+  frame_header_t *next; // The freelist and the remote stack link.
+};
+
+size_t frame_size_class(size_t size) noexcept {
+  size += sizeof(frame_header_t);
+  for (size_t i = 0; i < kFrameSizeClassCount; ++i) {
+    if (size <= kFrameSizeClasses[i]) return i;
+  }
+  return kFrameSizeClassCount;
+}
+
+frame_header_t *new_frame_block(size_t index, FrameCache *owner) {
+  return new (::operator new(kFrameSizeClasses[index]))
+    frame_header_t{owner, nullptr};
+}
+
+// The thread cache, never deleted(the other threads may still return the
+// frames to it), a new thread adopt the exited thread's one.
+struct FrameCache {
+
+  struct free_list_t {
+    frame_header_t *head{nullptr};
+    size_t count{0};
+  };
+
+  free_list_t lists[kFrameSizeClassCount];
+  std::atomic<frame_header_t *> remote[kFrameSizeClassCount]{};
+
+  void *allocate(size_t index) {
+    auto &list = lists[index];
+    if (!list.head) take_remote(index);
+    frame_header_t *header{nullptr};
+    if (list.head) {
+      header = list.head;
+      list.head = header->next;
+      --list.count;
+      header->next = nullptr;
+    } else {
+      header = new_frame_block(index, this);
+    }
+    return header + 1;
+  }
+
+  void free_local(size_t index, frame_header_t *header) noexcept {
+    auto &list = lists[index];
+    if (list.count >= kFrameFreeMaxCount) return ::operator delete(header);
+    header->next = list.head;
+    list.head = header;
+    ++list.count;
+  }
+
+  void free_remote(size_t index, frame_header_t *header) noexcept {
+    auto &head = remote[index];
+    header->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(
+      header->next, header,
+      std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Take all(the freelist empty), the producer will allocate them again.
+  void take_remote(size_t index) noexcept {
+    auto &list = lists[index];
+    list.head = remote[index].exchange(nullptr, std::memory_order_acquire);
+    for (auto header = list.head; header; header = header->next)
+      ++list.count;
+  }
+
+  void release() noexcept {
+    for (size_t i = 0; i < kFrameSizeClassCount; ++i) {
+      auto header = remote[i].exchange(nullptr, std::memory_order_acquire);
+      while (header) {
+        auto next = header->next;
+        ::operator delete(header);
+        header = next;
+      }
+      while (lists[i].head) {
+        auto next = lists[i].head->next;
+        ::operator delete(lists[i].head);
+        lists[i].head = next;
+      }
+      lists[i].count = 0;
+    }
+  }
+
+};
+
+// The exited threads caches.
+struct frame_cache_registry_t {
+  std::mutex mutex;
+  std::vector<FrameCache *> exited;
+};
+
+frame_cache_registry_t &frame_cache_registry() noexcept {
+  static auto r = new frame_cache_registry_t; // Threads may exit after main.
+  return *r;
+}
+
+// The trivial thread local(no init guard on the fast path).
+struct frame_thread_t {
+  FrameCache *cache;
+  bool exited; // Set when the thread local destructors begin.
+};
+
+thread_local frame_thread_t t_frame_thread{nullptr, false};
+
+// Only touched when the cache created, exit it with the thread.
+struct FrameCacheHolder {
+  ~FrameCacheHolder() {
+    t_frame_thread.exited = true;
+    auto cache = std::exchange(t_frame_thread.cache, nullptr);
+    if (!cache) return;
+    cache->release();
+    auto &registry = frame_cache_registry();
+    std::unique_lock<std::mutex> lock{registry.mutex};
+    registry.exited.emplace_back(cache);
+  }
+};
+
+thread_local FrameCacheHolder t_frame_cache_holder;
+
+FrameCache *create_frame_cache() {
+  [[maybe_unused]] auto &holder = t_frame_cache_holder;
+  auto &registry = frame_cache_registry();
+  {
+    std::unique_lock<std::mutex> lock{registry.mutex};
+    if (!registry.exited.empty()) {
+      t_frame_thread.cache = registry.exited.back();
+      registry.exited.pop_back();
+    }
+  }
+  if (!t_frame_thread.cache) t_frame_thread.cache = new FrameCache;
+  return t_frame_thread.cache;
+}
+
+} // namespace
+
+void *allocate_frame(size_t size) {
+  auto index = frame_size_class(size);
+  if (index == kFrameSizeClassCount) return ::operator new(size);
+  auto &thread = t_frame_thread;
+  if (thread.cache) [[likely]] return thread.cache->allocate(index);
+  if (thread.exited) return new_frame_block(index, nullptr) + 1;
+  return create_frame_cache()->allocate(index);
+}
+
+void deallocate_frame(void *ptr, size_t size) noexcept {
+  auto index = frame_size_class(size);
+  if (index == kFrameSizeClassCount) return ::operator delete(ptr);
+  auto header = static_cast<frame_header_t *>(ptr) - 1;
+  auto owner = header->owner;
+  if (!owner) return ::operator delete(header);
+  if (owner == t_frame_thread.cache) return owner->free_local(index, header);
+  owner->free_remote(index, header);
+}
+
+} // namespace plain::concurrency::detail
@@ -1,6 +1,8 @@
 #include "plain/concurrency/task.h"
 #include "plain/concurrency/result/detail/consumer_context.h"
 #include <cstring>
+#include <mutex>
+#include <new>
 
 using plain::concurrency::Task;
 using plain::concurrency::detail::vtable;
@@ -40,6 +42,144 @@ class CoroutineHandleFunctor : noncopyable {
 
 };
 
+// Set when the thread local destructors begin.
+thread_local bool t_task_thread_exited{false};
+
+struct TaskCounter;
+
+// The living threads blocks and the exited sum.
+struct task_counter_registry_t {
+  std::mutex mutex;
+  std::vector<TaskCounter *> blocks;
+  task_counters_t exited;
+};
+
+task_counter_registry_t &task_counter_registry() noexcept {
+  static auto r = new task_counter_registry_t; // Threads may exit after main.
+  return *r;
+}
+
+// The thread counts, the owner only add(no lock prefix) and the others read.
+struct TaskCounter {
+  std::atomic<uint64_t> inline_count{0};
+  std::atomic<uint64_t> heap_count{0};
+  std::atomic<uint64_t> pooled_count{0};
+  TaskCounter() {
+    auto &registry = task_counter_registry();
+    std::unique_lock<std::mutex> lock{registry.mutex};
+    registry.blocks.emplace_back(this);
+  }
+  ~TaskCounter() {
+    t_task_thread_exited = true;
+    auto &registry = task_counter_registry();
+    std::unique_lock<std::mutex> lock{registry.mutex};
+    registry.exited.inline_count += inline_count.load();
+    registry.exited.heap_count += heap_count.load();
+    registry.exited.pooled_count += pooled_count.load();
+    std::erase(registry.blocks, this);
+  }
+};
+
+thread_local TaskCounter t_task_counter;
+
+void increase(std::atomic<uint64_t> TaskCounter::*count) noexcept {
+  if (t_task_thread_exited) return; // Not register again when exiting.
+  auto &value = t_task_counter.*count;
+  value.store(value.load(std::memory_order_relaxed) + 1,
+    std::memory_order_relaxed);
+}
+
+// The spilled callable size classes, each keep some blocks in the thread.
+constexpr size_t kTaskSizeClasses[]{64, 128, 256, 512};
+constexpr size_t kTaskSizeClassCount{std::size(kTaskSizeClasses)};
+constexpr size_t kTaskFreeMaxCount{256};
+
+size_t task_size_class(size_t size, size_t align) noexcept {
+  if (align > alignof(std::max_align_t)) return kTaskSizeClassCount;
+  for (size_t i = 0; i < kTaskSizeClassCount; ++i) {
+    if (size <= kTaskSizeClasses[i]) return i;
+  }
+  return kTaskSizeClassCount;
+}
+
+struct task_free_block_t {
+  task_free_block_t *next;
+};
+
+struct TaskCache {
+  struct free_list_t {
+    task_free_block_t *head{nullptr};
+    size_t count{0};
+  } lists[kTaskSizeClassCount];
+  ~TaskCache() {
+    t_task_thread_exited = true; // The later thread local destructors.
+    for (auto &list : lists) {
+      while (list.head) {
+        auto block = list.head;
+        list.head = block->next;
+        ::operator delete(block);
+      }
+    }
+  }
+};
+
+thread_local TaskCache t_task_cache;
+
+} // namespace
+
+namespace detail {
+
+void *allocate_task(size_t size, size_t align) {
+  increase(&TaskCounter::heap_count);
+  auto index = task_size_class(size, align);
+  if (index == kTaskSizeClassCount) {
+    if (align > alignof(std::max_align_t))
+      return ::operator new(size, std::align_val_t{align});
+    return ::operator new(size);
+  }
+  if (!t_task_thread_exited) {
+    auto &list = t_task_cache.lists[index];
+    if (list.head) {
+      auto block = list.head;
+      list.head = block->next;
+      --list.count;
+      increase(&TaskCounter::pooled_count);
+      return block;
+    }
+  }
+  return ::operator new(kTaskSizeClasses[index]);
+}
+
+void deallocate_task(void *ptr, size_t size, size_t align) noexcept {
+  auto index = task_size_class(size, align);
+  if (index == kTaskSizeClassCount) {
+    if (align > alignof(std::max_align_t))
+      return ::operator delete(ptr, std::align_val_t{align});
+    return ::operator delete(ptr);
+  }
+  if (t_task_thread_exited) return ::operator delete(ptr);
+  auto &list = t_task_cache.lists[index];
+  if (list.count >= kTaskFreeMaxCount) return ::operator delete(ptr);
+  list.head = new (ptr) task_free_block_t{list.head};
+  ++list.count;
+}
+
+void count_inline_task() noexcept {
+  increase(&TaskCounter::inline_count);
+}
+
+} // namespace detail
+
+task_counters_t task_counters() noexcept {
+  auto &registry = task_counter_registry();
+  std::unique_lock<std::mutex> lock{registry.mutex};
+  auto r = registry.exited;
+  for (auto block : registry.blocks) {
+    r.inline_count += block->inline_count.load(std::memory_order_relaxed);
+    r.heap_count += block->heap_count.load(std::memory_order_relaxed);
+    r.pooled_count += block->pooled_count.load(std::memory_order_relaxed);
+  }
+  return r;
 }
 
 } // namespace plain::concurrency
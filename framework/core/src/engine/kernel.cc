@@ -1,4 +1,5 @@
 #include "plain/engine/kernel.h"
+#include <algorithm>
 #include <map>
 #include "plain/basic/type/byte.h"
 #include "plain/basic/time.h"
@@ -52,6 +53,17 @@ struct executor_collection {
   }
 };
 
+// The "cpu/node ..." or "none".
+std::string format_cpus(const std::vector<int32_t> &cpus) {
+  if (cpus.empty()) return "none";
+  std::string r;
+  for (auto cpu : cpus) {
+    if (!r.empty()) r += " ";
+    r += std::to_string(cpu) + "/" + std::to_string(thread::numa_node(cpu));
+  }
+  return r;
+}
+
 }
 }
 
@@ -63,7 +75,9 @@ engine_option::engine_option() noexcept :
   max_thread_pool_executor_waiting_time{detail::kDefaultMaxWorkerWaitTime},
   max_background_threads{detail::default_max_background_workers()},
   max_background_executor_waiting_time{detail::kDefaultMaxWorkerWaitTime},
-  max_timer_queue_waiting_time{std::chrono::seconds(60 * 2)} {
+  max_timer_queue_waiting_time{std::chrono::seconds(60 * 2)},
+  timer_queue_mode{TimerQueueMode::Set},
+  timer_queue_tick{std::chrono::milliseconds(1)} {
 
 }
 
@@ -77,6 +91,7 @@ struct Kernel::Impl {
   std::shared_ptr<concurrency::executor::ThreadPool> thread_pool_executor;
   std::shared_ptr<concurrency::executor::ThreadPool> background_executor;
   std::shared_ptr<concurrency::executor::Thread> thread_executor;
+  engine_option option;
   detail::executor_collection registered_executors;
   std::unique_ptr<net::Listener> console_listener;
   std::map<std::string, std::weak_ptr<net::connection::Manager>> nets;
@@ -88,11 +103,12 @@ struct Kernel::Impl {
   static std::string console_cmd_list(const std::vector<std::string> &args);
   static std::string console_cmd_kill(const std::vector<std::string> &args);
   static std::string console_cmd_help(const std::vector<std::string> &args);
+  static std::string console_cmd_affinity(
+    const std::vector<std::string> &args);
 };
 
 std::string Kernel::Impl::console_cmd_list(
   const std::vector<std::string> &args) {
-  UNUSED(args);
   std::unique_lock<decltype(ENGINE->impl_->mutex)>
     auto_lock{ENGINE->impl_->mutex};
   std::string r;
@@ -106,11 +122,30 @@ std::string Kernel::Impl::console_cmd_list(
         r += net->setting_.name;
         r += " count: " + std::to_string(net->size());
         r += " maxcount: " + std::to_string(net->setting_.max_count);
-        r += " send: " + format_size(net->send_size());
-        r += " recv: " + format_size(net->recv_size());
+        auto stats = net->stats();
+        r += " send: " + format_size(stats.send_size);
+        r += " recv: " + format_size(stats.recv_size);
+        r += " packets(in/out): " + std::to_string(stats.recv_packet_count) +
+          "/" + std::to_string(stats.send_packet_count);
+        r += " decode errors: " + std::to_string(stats.decode_error_count);
+        r += " zero copy: " + format_size(stats.send_zero_copy_size);
+        r += " queues(work/send): " + std::to_string(stats.work_queue_size) +
+          "/" + std::to_string(stats.send_queue_size);
+        r += " buffered(in/out): " + format_size(stats.input_size) + "/" +
+          format_size(stats.output_size);
         r += " address: " + net->setting_.address;
         r += " mode: " + net::get_mode_name(net->setting_.mode);
         r += "\r\n";
+        // The named nets list each connection too(list name ...).
+        if (std::find(args.begin(), args.end(), it.first) == args.end())
+          continue;
+        for (const auto &conn : net->conn_stats()) {
+          r += "\t\tid: " + std::to_string(conn.id);
+          r += " buffered(in/out): " + format_size(conn.input_size) + "/" +
+            format_size(conn.output_size);
+          r += " queued: " + std::to_string(conn.send_queue_size);
+          r += "\r\n";
+        }
       }
     }
   }
@@ -191,6 +226,33 @@ std::string Kernel::Impl::console_cmd_help(
   return r;
 }
 
+std::string Kernel::Impl::console_cmd_affinity(
+  const std::vector<std::string> &args) {
+  UNUSED(args);
+  const auto &option = ENGINE->impl_->option;
+  std::string r;
+  r += "Cpus(cpu/node): " + detail::format_cpus(thread::get_affinity());
+  r += "\r\n\tthread pool executor workers: " +
+    std::to_string(option.max_cpu_threads) + " cpus: " +
+    detail::format_cpus(option.thread_pool_cpus);
+  r += "\r\n\tbackground executor workers: " +
+    std::to_string(option.max_cpu_threads) + " cpus: " +
+    detail::format_cpus(option.background_cpus);
+  r += "\r\n\tthread executor cpus: " +
+    detail::format_cpus(option.thread_executor_cpus);
+  r += "\r\n\tworker thread executor cpus: " +
+    detail::format_cpus(option.worker_thread_cpus);
+  std::unique_lock<decltype(ENGINE->impl_->mutex)>
+    auto_lock{ENGINE->impl_->mutex};
+  for (auto it : ENGINE->impl_->nets) {
+    auto net = it.second.lock();
+    if (!net) continue;
+    r += "\r\n\tnet " + net->setting_.name + " cpus: " +
+      detail::format_cpus(net->setting_.cpus);
+  }
+  return r;
+}
+
 Kernel::Kernel() : Kernel(plain::engine_option{}) {
 
 }
@@ -200,7 +262,8 @@ Kernel::Kernel(const engine_option &option) : impl_{std::make_unique<Impl>()} {
 
   impl_->timer_queue = std::make_shared<TimerQueue>(
     option.max_timer_queue_waiting_time,
-    option.thread_started_callback, option.thread_terminated_callback);
+    option.thread_started_callback, option.thread_terminated_callback,
+    option.timer_queue_mode, option.timer_queue_tick);
 
   impl_->inline_executor = std::make_shared<executor::Inline>();
   impl_->registered_executors.register_executor(impl_->inline_executor);
@@ -209,7 +272,9 @@ Kernel::Kernel(const engine_option &option) : impl_{std::make_unique<Impl>()} {
     "thread pool executor", option.max_cpu_threads, 
     option.max_thread_pool_executor_waiting_time,
     option.thread_started_callback,
-    option.thread_terminated_callback
+    option.thread_terminated_callback,
+    option.thread_pool_wait_policy,
+    option.thread_pool_cpus
   );
   impl_->registered_executors.register_executor(impl_->thread_pool_executor);
 
@@ -217,18 +282,27 @@ Kernel::Kernel(const engine_option &option) : impl_{std::make_unique<Impl>()} {
     "thread background executor", option.max_cpu_threads, 
     option.max_thread_pool_executor_waiting_time,
     option.thread_started_callback,
-    option.thread_terminated_callback
+    option.thread_terminated_callback,
+    option.background_wait_policy,
+    option.background_cpus
   );
   impl_->registered_executors.register_executor(impl_->background_executor);
 
   impl_->thread_executor = std::make_shared<executor::Thread>(
-    option.thread_started_callback, option.thread_terminated_callback);
+    option.thread_started_callback, option.thread_terminated_callback,
+    option.thread_executor_cpus);
   impl_->registered_executors.register_executor(impl_->thread_executor);
+  impl_->option = option;
 
-  register_console_handler("list", Impl::console_cmd_list, "Show net list");
+  register_console_handler(
+    "list", Impl::console_cmd_list,
+    "Show net list, list name1 name2 ... (show their connections too)");
   register_console_handler(
     "kill", Impl::console_cmd_kill, "Kill net from list(kill name1 name2 ...)");
   register_console_handler("killall", Impl::console_cmd_kill, "Kill all net");
+  register_console_handler(
+    "affinity", Impl::console_cmd_affinity,
+    "Show the executors and nets pinned cpus(cpu/numa node)");
   register_console_handler(
     "help", Impl::console_cmd_help,
     "Show help to use commands, help command1 command2 (empty will show all)");
@@ -270,7 +344,9 @@ Kernel::thread_executor() const noexcept {
 std::shared_ptr<plain::concurrency::executor::WorkerThread>
 Kernel::make_worker_thread_executor() {
   using plain::concurrency::executor::WorkerThread;
-  auto executor = std::make_shared<WorkerThread>();
+  auto executor = std::make_shared<WorkerThread>(
+    nullptr, nullptr, impl_->option.worker_thread_wait_policy,
+    impl_->option.worker_thread_cpus);
   impl_->registered_executors.register_executor(executor);
   return executor;
 }
@@ -336,7 +412,7 @@ bool Kernel::enable_console(std::string_view addr) noexcept {
     params.erase(params.begin());
     auto r = it->second(params);
     if (!r.empty()) {
-      auto p = std::make_shared<net::packet::Basic>();
+      auto p = conn->new_packet();
       p->set_writeable(true);
       r += "\r";
       p->write(as_const_bytes(r));
@@ -347,7 +423,8 @@ bool Kernel::enable_console(std::string_view addr) noexcept {
   });
   
   impl_->console_listener->set_codec(
-    {.encode = net::stream::line_encode, .decode = net::stream::line_decode});
+    {.decode = net::stream::line_decode,
+     .encode_to = net::stream::line_encode_to});
 
   return true;
 }
@@ -1,4 +1,5 @@
 #include "plain/engine/timer_queue.h"
+#include <array>
 #include <set>
 #include "plain/concurrency/executor/basic.h"
 #include "plain/concurrency/result/lazy.h"
@@ -122,6 +123,201 @@ class TimerQueueInternal {
 
 }
 
+// The hierarchical timing wheel, kLevelCount levels and each one have
+// kSlotCount slots(the level tick is the lower level whole). The timers
+// linked in the slots intrusively, so add and remove are O(1), the higher
+// level timers cascade to the lower when its slot reached.
+class TimerWheel {
+
+ public:
+  TimerWheel(std::chrono::milliseconds tick) :
+    tick_{tick.count() > 0 ? tick : std::chrono::milliseconds(1)},
+    origin_{clock_type::now()} {
+
+  }
+  ~TimerWheel() noexcept {
+    for (auto &head : slots_) { // The long links released one by one.
+      while (head) head = std::move(head->wheel_next_);
+    }
+  }
+
+ public:
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  ::time_point_t process_timers(request_queue_t &queue) {
+    auto now = clock_type::now();
+    if (empty()) current_ = std::max(current_, to_tick(now, false));
+    process_request_queue(queue);
+    advance(to_tick(now, false));
+    if (empty()) return now + std::chrono::hours(24);
+    return origin_ + tick_ * next_tick();
+  }
+
+ private:
+  static constexpr uint32_t kLevelBits{8};
+  static constexpr uint32_t kLevelCount{4};
+  static constexpr uint64_t kSlotCount{1 << kLevelBits};
+  static constexpr uint64_t kSlotMask{kSlotCount - 1};
+  static constexpr uint64_t kTickMax{(uint64_t{1} << (kLevelBits * kLevelCount)) - 1};
+  const std::chrono::milliseconds tick_;
+  const ::time_point_t origin_;
+  uint64_t current_{0}; // The next tick to process.
+  size_t size_{0};
+  std::array<size_t, kLevelCount> level_sizes_{};
+  std::array<timer_ptr_t, kSlotCount * kLevelCount> slots_;
+
+ private:
+  uint64_t to_tick(::time_point_t time_point, bool up) const noexcept {
+    if (time_point <= origin_) return 0;
+    auto diff = time_point - origin_;
+    auto r = static_cast<uint64_t>(diff / tick_);
+    if (up && origin_ + tick_ * r < time_point) ++r;
+    return r;
+  }
+
+  void add(timer_ptr_t timer) {
+    auto expiry = std::max(to_tick(timer->get_deadline(), true), current_);
+    timer->wheel_expiry_ = expiry;
+    link(std::move(timer), expiry);
+  }
+
+  // The delta far than the wheel put in the last level and cascade again.
+  void link(timer_ptr_t timer, uint64_t expiry) {
+    auto delta = std::min(expiry - current_, kTickMax);
+    expiry = current_ + delta;
+    uint32_t level{0};
+    while (level + 1 < kLevelCount && delta >= (kSlotCount << (level * kLevelBits)))
+      ++level;
+    auto index = (expiry >> (level * kLevelBits)) & kSlotMask;
+    auto slot = static_cast<int32_t>(level * kSlotCount + index);
+    auto &head = slots_[slot];
+    timer->wheel_slot_ = slot;
+    timer->wheel_prev_ = nullptr;
+    if (head) head->wheel_prev_ = timer.get();
+    timer->wheel_next_ = std::move(head);
+    head = std::move(timer);
+    ++level_sizes_[level];
+    ++size_;
+  }
+
+  void unlink(TimerStateBasic *timer) noexcept {
+    if (timer->wheel_slot_ < 0) return;
+    auto slot = static_cast<size_t>(timer->wheel_slot_);
+    auto next = std::move(timer->wheel_next_);
+    if (next) next->wheel_prev_ = timer->wheel_prev_;
+    if (timer->wheel_prev_) {
+      timer->wheel_prev_->wheel_next_ = std::move(next); // Release timer.
+    } else {
+      slots_[slot] = std::move(next);
+    }
+    timer->wheel_prev_ = nullptr;
+    timer->wheel_slot_ = -1;
+    --level_sizes_[slot / kSlotCount];
+    --size_;
+  }
+
+  // Take the slot links out.
+  timer_ptr_t detach(uint32_t level, uint64_t index) noexcept {
+    auto &head = slots_[level * kSlotCount + index];
+    size_t count{0};
+    for (auto timer = head.get(); timer; timer = timer->wheel_next_.get()) {
+      timer->wheel_slot_ = -1;
+      timer->wheel_prev_ = nullptr;
+      ++count;
+    }
+    level_sizes_[level] -= count;
+    size_ -= count;
+    return std::move(head);
+  }
+
+  void cascade(uint32_t level) {
+    auto index = (current_ >> (level * kLevelBits)) & kSlotMask;
+    auto timer = detach(level, index);
+    while (timer) {
+      auto next = std::move(timer->wheel_next_);
+      auto expiry = timer->wheel_expiry_;
+      link(std::move(timer), expiry);
+      timer = std::move(next);
+    }
+    if (index == 0 && level + 1 < kLevelCount) cascade(level + 1);
+  }
+
+  void advance(uint64_t target) {
+    while (current_ <= target) {
+      auto index = current_ & kSlotMask;
+      if (index == 0 && current_ > 0) cascade(1);
+      auto timer = detach(0, index);
+      ++current_;
+      while (timer) {
+        auto next = std::move(timer->wheel_next_);
+        fire(std::move(timer));
+        timer = std::move(next);
+      }
+      // Skip the empty ticks to the next cascade.
+      if (level_sizes_[0] > 0) continue;
+      uint64_t step{kSlotCount};
+      uint32_t level{1};
+      while (level < kLevelCount && level_sizes_[level] == 0) {
+        step <<= kLevelBits;
+        ++level;
+      }
+      if (level == kLevelCount) {
+        current_ = std::max(current_, target + 1);
+        break;
+      }
+      auto next_tick = (current_ + step - 1) & ~(step - 1);
+      current_ = std::min(next_tick, target + 1);
+    }
+  }
+
+  // The earliest tick maybe fire(or cascade).
+  uint64_t next_tick() const noexcept {
+    uint64_t r{kTickMax + current_};
+    if (level_sizes_[0] > 0) {
+      for (uint64_t i = 0; i < kSlotCount; ++i) {
+        if (slots_[(current_ + i) & kSlotMask]) {
+          r = current_ + i;
+          break;
+        }
+      }
+    }
+    uint64_t step{kSlotCount};
+    for (uint32_t level = 1; level < kLevelCount; ++level) {
+      if (level_sizes_[level] > 0) {
+        r = std::min(r, (current_ + step - 1) & ~(step - 1));
+        break;
+      }
+      step <<= kLevelBits;
+    }
+    return r;
+  }
+
+  void fire(timer_ptr_t timer) {
+    auto expiry = timer->wheel_expiry_;
+    if (expiry >= current_) { // The far timer not reached.
+      link(std::move(timer), expiry);
+      return;
+    }
+    if (timer->cancelled()) return;
+    timer->fire();
+    if (timer->is_oneshot()) return;
+    add(std::move(timer));
+  }
+
+  void process_request_queue(request_queue_t &queue) {
+    for (auto &request : queue) {
+      if (request.second == TimerRequest::Add) {
+        add(std::move(request.first));
+      } else {
+        unlink(request.first.get());
+      }
+    }
+  }
+
+};
+
 } // namespace plain::detail
 
 struct TimerQueue::Impl {
@@ -135,11 +331,15 @@ struct TimerQueue::Impl {
   const std::chrono::milliseconds max_waiting_time;
   const std::function<void(std::string_view)> started_callback;
   const std::function<void(std::string_view)> terminated_callback;
+  const TimerQueueMode mode;
+  const std::chrono::milliseconds tick;
   
   Impl(
     std::chrono::milliseconds max_waiting_time,
     const std::function<void(std::string_view name)> &started_callback,
-    const std::function<void(std::string_view name)> &terminated_callback);
+    const std::function<void(std::string_view name)> &terminated_callback,
+    TimerQueueMode mode,
+    std::chrono::milliseconds tick);
 
   thread_t ensure_worker_thread(std::unique_lock<std::mutex> &lock);
   
@@ -151,17 +351,21 @@ struct TimerQueue::Impl {
     std::shared_ptr<TimerQueue> self,
     std::shared_ptr<concurrency::executor::Basic> executor);
 
-  void work_loop();
+  template <typename T>
+  void work_loop(T &internal_state);
 };
 
 TimerQueue::Impl::Impl(
   std::chrono::milliseconds max_waiting_time,
   const std::function<void(std::string_view name)> &started_callback,
-  const std::function<void(std::string_view name)> &terminated_callback) :
+  const std::function<void(std::string_view name)> &terminated_callback,
+  TimerQueueMode _mode,
+  std::chrono::milliseconds _tick) :
   atomic_abort{false}, abort{false}, idle{true},
   max_waiting_time{max_waiting_time},
   started_callback{started_callback},
-  terminated_callback{terminated_callback} {
+  terminated_callback{terminated_callback},
+  mode{_mode}, tick{_tick} {
 
 }
 
@@ -176,7 +380,13 @@ plain::thread_t TimerQueue::Impl::ensure_worker_thread(
     thread::set_name(name);
     if (static_cast<bool>(started_callback))
       started_callback(name);
-    work_loop();
+    if (mode == TimerQueueMode::Wheel) {
+      detail::TimerWheel internal_state{tick};
+      work_loop(internal_state);
+    } else {
+      detail::TimerQueueInternal internal_state;
+      work_loop(internal_state);
+    }
     if (static_cast<bool>(terminated_callback))
       terminated_callback(name);
   });
@@ -235,9 +445,9 @@ plain::concurrency::LazyResult<void> TimerQueue::Impl::make_delay_object_impl(
     static_cast<size_t>(due_time.count()), *self, std::move(executor)};
 }
 
-void TimerQueue::Impl::work_loop() {
+template <typename T>
+void TimerQueue::Impl::work_loop(T &internal_state) {
   time_point_t next_deadline;
-  detail::TimerQueueInternal internal_state;
 
   while (true) {
     std::unique_lock<decltype(lock)> _lock(lock);
@@ -271,9 +481,11 @@ void TimerQueue::Impl::work_loop() {
 TimerQueue::TimerQueue(
   std::chrono::milliseconds max_waiting_time,
   const std::function<void(std::string_view name)> &started_callback,
-  const std::function<void(std::string_view name)> &terminated_callback) :
+  const std::function<void(std::string_view name)> &terminated_callback,
+  TimerQueueMode mode,
+  std::chrono::milliseconds tick) :
   impl_{std::make_unique<Impl>(
-    max_waiting_time, started_callback, terminated_callback)} {
+    max_waiting_time, started_callback, terminated_callback, mode, tick)} {
 
 }
 
@@ -319,6 +531,10 @@ std::chrono::milliseconds TimerQueue::max_worker_idle_time() const noexcept {
   return impl_->max_waiting_time;
 }
 
+plain::TimerQueueMode TimerQueue::mode() const noexcept {
+  return impl_->mode;
+}
+
 plain::concurrency::LazyResult<void> TimerQueue::make_delay_object(
   std::chrono::milliseconds due_time,
   std::shared_ptr<concurrency::executor::Basic> executor) {
@@ -1,8 +1,15 @@
 #include "plain/net/connection/basic.h"
+#include <limits>
 #include <map>
+#include <thread>
+#include <variant>
 #include "plain/basic/utility.h"
+#include "plain/basic/mpsc_queue.h"
 #include "plain/basic/logger.h"
 #include "plain/concurrency/executor/basic.h"
+#include "plain/concurrency/executor/inline.h"
+#include "plain/engine/kernel.h"
+#include "plain/engine/timer_queue.h"
 #include "plain/net/detail/coroutine.h"
 #include "plain/net/socket/basic.h"
 #include "plain/net/stream/basic.h"
@@ -16,7 +23,6 @@ using plain::net::connection::Basic;
 using plain::net::connection::callable_func;
 
 static std::unordered_map<std::string, callable_func> s_callables;
-static constexpr size_t kOnceHandlePacketCount{12};
 static constexpr size_t kCantPeekMaxCount{60};
 
 static std::string
@@ -39,20 +45,52 @@ struct Basic::Impl {
   id_t id;
   std::shared_ptr<socket::Basic> socket;
   std::unique_ptr<stream::Basic> istream;
-  std::unique_ptr<stream::Basic> ostream;
+  std::shared_ptr<stream::Basic> ostream; // The zero copy sending own it.
   stream::codec_t codec;
   std::weak_ptr<Manager> manager;
   packet::dispatch_func dispatcher;
   uint8_t error_times{0};
-  uint8_t work_flags{0};
+  std::atomic_uint8_t work_flags{0};
   std::atomic_bool working{false};
   std::atomic_bool keep_alive{false};
-  mutable std::mutex mutex;
+  mutable std::mutex mutex; // For rpc calls.
+  // The senders push here and the worker encode them into the ostream(the
+  // broadcast bytes encoded once and appended without copy).
+  using send_t =
+    std::variant<std::shared_ptr<packet::Basic>, std::shared_ptr<const bytes_t>>;
+  MpscQueue<send_t> send_queue;
+  std::atomic_size_t send_queue_size{0};
+  std::atomic_flag output_busy; // The ostream consumer(only one).
+  std::atomic_bool output_missed{false}; // The output came when busy.
+  // The ostream front block is sending without copy, it must not move(no
+  // encode) until sent.
+  std::atomic_bool zero_copy_sending{false};
+  bool want_write{false}; // The write readiness armed(the output consumer).
+  std::atomic_bool corked{false};
+  std::atomic_bool peer_batch{false}; // The peer sent the rpc batch.
+  // The rpc packets wait for the batch frame(the output consumer).
+  std::vector<std::shared_ptr<packet::Basic>> batch;
+  size_t batch_bytes{0};
+  std::atomic_bool over_high_watermark{false};
+  std::atomic_int64_t input_time{0}; // The manager idle clock.
+  std::atomic_int64_t output_time{0};
   
-  // For rpc calls.
-  using call_t = std::pair<std::string, std::promise<rpc::Unpacker>>;
-  std::atomic_uint32_t call_index{0};
-  std::unordered_map<uint32_t, call_t> callings;
+  // For rpc calls, the deadline timers hold the callings weakly.
+  struct call_t {
+    std::string name;
+    concurrency::ResultPromise<rpc::Unpacker> promise;
+    Timer deadline;
+  };
+  struct callings_t {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, call_t> map;
+    std::optional<call_t> take(uint32_t index);
+    void fail(uint32_t index, const std::string &message);
+    void fail_all(const std::string &message);
+  };
+  std::atomic_uint32_t call_index{0}; // Not reset, the old deadline ignored.
+  std::shared_ptr<const rpc::method_table_t> rpc_methods; // The peer sent.
+  std::shared_ptr<callings_t> callings{std::make_shared<callings_t>()};
   std::optional<int64_t> timeout{std::nullopt};
 
   bool process_input(Basic *conn) noexcept;
@@ -60,6 +98,9 @@ struct Basic::Impl {
   net::detail::Task<> process_input_await(Basic *conn) noexcept;
   net::detail::Task<> process_output_await(Basic *conn) noexcept;
   bool process_command(Basic *conn) noexcept;
+  bool dispatch(Basic *conn, std::shared_ptr<packet::Basic> packet) noexcept;
+  bool handle_rpc_batch(Basic *conn, std::shared_ptr<packet::Basic> packet);
+  bool handle_rpc_methods(packet::Basic &packet);
   bool process_exception() noexcept;
   bool work(Basic *conn) noexcept;
   void enqueue_work() noexcept; 
@@ -70,13 +111,19 @@ struct Basic::Impl {
   bool handle_rpc_request(Basic *conn, std::shared_ptr<packet::Basic> packet);
   bool handle_rpc_response(Basic *conn, std::shared_ptr<packet::Basic> packet);
   bool write(const std::shared_ptr<packet::Basic> &packet) noexcept;
+  bool flush_send_queue(Basic *conn) noexcept;
+  void clear_send_queue() noexcept;
+  void clear_ostream() noexcept;
+  size_t batch_count(Manager *m) const noexcept;
+  bool flush_batch(Basic *conn) noexcept;
+  void check_watermark(Basic *conn, Manager *m) noexcept;
 };
 
 Basic::Impl::Impl() :
   id{kInvalidId},
   socket{std::make_shared<socket::Basic>()},
   istream{std::make_unique<stream::Basic>(socket)},
-  ostream{std::make_unique<stream::Basic>(socket)},
+  ostream{std::make_shared<stream::Basic>(socket)},
   codec{}, manager{} {
 
 }
@@ -85,35 +132,63 @@ Basic::Impl::Impl(std::shared_ptr<socket::Basic> socket) :
   id{kInvalidId},
   socket{socket},
   istream{std::make_unique<stream::Basic>(socket)},
-  ostream{std::make_unique<stream::Basic>(socket)},
+  ostream{std::make_shared<stream::Basic>(socket)},
   codec{}, manager{} {
 
 }
 
 Basic::Impl::~Impl() = default;
 
+std::optional<Basic::Impl::call_t>
+Basic::Impl::callings_t::take(uint32_t index) {
+  std::unique_lock<std::mutex> lock{mutex};
+  auto it = map.find(index);
+  if (it == map.end()) return std::nullopt;
+  std::optional<call_t> r{std::move(it->second)};
+  map.erase(it);
+  return r;
+}
+
+// Complete the promise out of the lock(the awaiter maybe resume inline).
+void Basic::Impl::callings_t::fail(
+  uint32_t index, const std::string &message) {
+  auto call = take(index);
+  if (!call) return;
+  call->promise.set_exception(
+    std::make_exception_ptr(std::logic_error(message)));
+}
+
+void Basic::Impl::callings_t::fail_all(const std::string &message) {
+  std::unordered_map<uint32_t, call_t> temp;
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    temp.swap(map);
+  }
+  for (auto &[index, call] : temp) {
+    call.promise.set_exception(std::make_exception_ptr(
+      std::logic_error("call " + call.name + " " + message)));
+  }
+}
+
 bool Basic::Impl::process_input(Basic *conn) noexcept {
   if (!has_work_flag(WorkFlag::Input)) return true;
-  scoped_executor_t check_flag([this]{
-    if (socket->avail() == 0)
-      set_work_flag(WorkFlag::Input, false);
-  });
   assert(conn);
   if (!socket->valid()) return false;
-  auto r = istream->pull();
+  auto m = manager.lock();
+  // Clear before pull, the data arrived in pulling will enqueue it again.
+  set_work_flag(WorkFlag::Input, false);
+  auto r = istream->pull(m ? m->setting_.recv_budget_size : 0);
   if (r < 0) {
     LOG_ERROR << get_name(conn) << " pull failed: " << r;
     return false;
   }
-  auto m = manager.lock();
+  // The budget used up, keep the flag(edge triggered will not notify again).
+  if (!istream->drained()) set_work_flag(WorkFlag::Input, true);
   if (m) {
     m->increase_recv_size(r);
+    if (r > 0) input_time.store(m->idle_clock(), std::memory_order_relaxed);
   }
   set_work_flag(WorkFlag::Command, true);
-  /*
-  if (socket->avail() == 0)
-    set_work_flag(WorkFlag::Input, false);
-  */
   return true;
 }
 
@@ -121,23 +196,161 @@ bool Basic::Impl::process_output(Basic *conn) noexcept {
   if (!has_work_flag(WorkFlag::Output)) return true;
   assert(conn);
   if (!socket->valid()) return false;
-  {
-    std::unique_lock<std::mutex> lock{mutex};
-    auto r = ostream->push();
-    if (r < 0) {
-      LOG_ERROR << get_name(conn) << " push failed: " << r;
-      return false;
-    }
-    auto m = manager.lock();
-    if (r > 0 && m) {
-      m->increase_send_size(r);
+  // Other worker is outputing, it enqueue the output again after(not spin
+  // here). Try again after the missed set, the holder may released before.
+  if (output_busy.test_and_set(std::memory_order_seq_cst)) {
+    set_work_flag(WorkFlag::Output, false);
+    output_missed.store(true, std::memory_order_seq_cst);
+    if (output_busy.test_and_set(std::memory_order_seq_cst)) return true;
+    output_missed.store(false, std::memory_order_relaxed);
+  }
+  scoped_executor_t output_free([this, conn]{
+    output_busy.clear(std::memory_order_seq_cst);
+    if (output_missed.exchange(false, std::memory_order_seq_cst))
+      conn->enqueue_work(WorkFlag::Output);
+  });
+  if (zero_copy_sending.load(std::memory_order_acquire)) {
+    // The sent will enqueue output again.
+    set_work_flag(WorkFlag::Output, false);
+    return true;
+  }
+  if (!flush_send_queue(conn)) return false;
+  auto m = manager.lock();
+  if (m && m->setting_.send_zero_copy_size > 0) {
+    auto bytes = ostream->read_block();
+    if (bytes.size() >= m->setting_.send_zero_copy_size) {
+      zero_copy_sending.store(true, std::memory_order_release);
+      if (m->send_zero_copy(conn, bytes, ostream)) {
+        set_work_flag(WorkFlag::Output, false);
+        return true;
+      }
+      zero_copy_sending.store(false, std::memory_order_release);
     }
   }
-  if (ostream->size() == 0)
+  auto r = ostream->push();
+  if (r < 0) {
+    LOG_ERROR << get_name(conn) << " push failed: " << r;
+    return false;
+  }
+  if (r > 0 && m) {
+    m->increase_send_size(r);
+    output_time.store(m->idle_clock(), std::memory_order_relaxed);
+  }
+  if (ostream->size() == 0) {
     set_work_flag(WorkFlag::Output, false);
+    // The sender pushed after flush saw the flag set, so take it back.
+    if (!send_queue.empty()) set_work_flag(WorkFlag::Output, true);
+    if (want_write && m) {
+      want_write = false;
+      m->sock_want_write(socket->id(), id, false);
+    }
+  } else if (m) {
+    // The peer window closed, wait the writable instead of working again.
+    // Clear before arm, the writable in arming will enqueue it again.
+    set_work_flag(WorkFlag::Output, false);
+    want_write = m->sock_want_write(socket->id(), id, true);
+    if (!want_write) set_work_flag(WorkFlag::Output, true);
+  }
+  if (m) check_watermark(conn, m.get());
   return true;
 }
 
+void Basic::Impl::check_watermark(Basic *conn, Manager *m) noexcept {
+  auto high = m->setting_.output_high_watermark;
+  if (high == 0) return;
+  auto size = ostream->size();
+  if (!over_high_watermark.load(std::memory_order_relaxed)) {
+    if (size < high) return;
+    over_high_watermark.store(true, std::memory_order_relaxed);
+    m->on_watermark(conn, true);
+  } else if (size <= m->setting_.output_low_watermark) {
+    over_high_watermark.store(false, std::memory_order_relaxed);
+    m->on_watermark(conn, false);
+  }
+}
+
+// The queued rpc packets in one flush write as the batch frame.
+// The producers count before push, so only subtract the drained ones(a
+// reset to zero may underflow when their packets drained later).
+void Basic::Impl::clear_send_queue() noexcept {
+  auto count = send_queue.consume([](send_t) {});
+  send_queue_size.fetch_sub(count, std::memory_order_relaxed);
+}
+
+// The output consumer(the io uring thread) may use the ostream now, wait it
+// released(it not blocks on others) then swap or clear.
+// The kernel may still read the zero copy sending bytes, the manager keep
+// the stream until released, so use a new one.
+void Basic::Impl::clear_ostream() noexcept {
+  while (output_busy.test_and_set(std::memory_order_seq_cst))
+    std::this_thread::yield();
+  if (zero_copy_sending.exchange(false, std::memory_order_acq_rel)) {
+    ostream = std::make_shared<stream::Basic>(socket);
+  } else {
+    ostream->clear();
+  }
+  output_missed.store(false, std::memory_order_relaxed); // Cleared.
+  output_busy.clear(std::memory_order_seq_cst);
+}
+
+bool Basic::Impl::flush_send_queue(Basic *conn) noexcept {
+  bool r{true};
+  auto m = manager.lock();
+  auto max_count = batch_count(m.get());
+  size_t max_bytes{m ? m->setting_.packet_limit.max_length : kPacketLengthMax};
+  auto count = send_queue.consume([&](send_t item) {
+    if (!r) return;
+    if (auto bytes = std::get_if<std::shared_ptr<const bytes_t>>(&item)) {
+      r = flush_batch(conn);
+      ostream->write(std::move(*bytes));
+      return;
+    }
+    auto &packet = std::get<std::shared_ptr<packet::Basic>>(item);
+    if (max_count > 0 && (packet->is_call_request() ||
+        packet->is_call_response() || packet->is_call_notify())) {
+      auto size = stream::batch_size(*packet);
+      if (batch_bytes + size > max_bytes) r = flush_batch(conn);
+      batch_bytes += size;
+      batch.emplace_back(std::move(packet));
+      if (batch.size() >= max_count) r = r && flush_batch(conn);
+      return;
+    }
+    r = flush_batch(conn);
+    if (r && !write(packet)) {
+      LOG_ERROR << get_name(conn) << " write packet failed: " << packet->id();
+      r = false;
+    }
+  });
+  r = flush_batch(conn) && r;
+  if (count == 0) return r;
+  send_queue_size.fetch_sub(count, std::memory_order_relaxed);
+  if (m) m->increase_send_packet(count);
+  return r;
+}
+
+// The custom codec not batch(the peer can't split it).
+size_t Basic::Impl::batch_count(Manager *m) const noexcept {
+  if (codec.encode_to || codec.encode) return 0;
+  if (!m) return 0;
+  if (m->codec().encode_to || m->codec().encode) return 0;
+  if (m->setting_.rpc_batch_count > 0) return m->setting_.rpc_batch_count;
+  return peer_batch.load(std::memory_order_relaxed) ? kRpcBatchCount : 0;
+}
+
+bool Basic::Impl::flush_batch(Basic *conn) noexcept {
+  if (batch.empty()) return true;
+  bool r{true};
+  if (batch.size() == 1) {
+    r = write(batch.front());
+  } else {
+    r = stream::encode_batch_to(ostream.get(), batch);
+  }
+  if (!r) LOG_ERROR << get_name(conn) << " write batch failed: " << batch.size();
+  batch.clear();
+  batch_bytes = 0;
+  return r;
+}
+
 plain::net::detail::Task<>
 Basic::Impl::process_input_await(Basic *conn) noexcept {
   auto m = manager.lock();
@@ -149,6 +362,7 @@ Basic::Impl::process_input_await(Basic *conn) noexcept {
     m->remove(id);
   }
   m->increase_recv_size(r);
+  if (r > 0) input_time.store(m->idle_clock(), std::memory_order_relaxed);
   set_work_flag(WorkFlag::Command, true);
 }
   
@@ -157,6 +371,16 @@ Basic::Impl::process_output_await(Basic *conn) noexcept {
   auto m = manager.lock();
   if (!m) co_return;
   auto sock_data = m->get_sock_data();
+  if (!output_busy.test_and_set(std::memory_order_acquire)) {
+    auto r = flush_send_queue(conn);
+    output_busy.clear(std::memory_order_seq_cst);
+    if (output_missed.exchange(false, std::memory_order_seq_cst))
+      conn->enqueue_work(WorkFlag::Output);
+    if (!r) {
+      m->remove(id);
+      co_return;
+    }
+  }
   for (;;) {
     auto r = co_await ostream->push_await(sock_data);
     if (ostream->size() == 0) break;
@@ -166,6 +390,7 @@ Basic::Impl::process_output_await(Basic *conn) noexcept {
       break;
     }
     m->increase_send_size(r);
+    output_time.store(m->idle_clock(), std::memory_order_relaxed);
   }
 }
 
@@ -187,7 +412,9 @@ bool Basic::Impl::process_command(Basic *conn) noexcept {
     func = m->codec().decode;
   }
   if (error_times >= kCantPeekMaxCount) return false;
-  for (size_t i = 0; i < kOnceHandlePacketCount; ++i) {
+  size_t budget_count{m ? m->setting_.recv_budget_count : kRecvBudgetCount};
+  if (budget_count == 0) budget_count = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < budget_count; ++i) {
     auto r = func(istream.get(), packet_limit);
     auto e = get_error(r);
     if (e) {
@@ -200,28 +427,74 @@ bool Basic::Impl::process_command(Basic *conn) noexcept {
         return true;
       }
       LOG_ERROR << get_name(conn) << " error: " << e->code();
+      if (m) m->increase_decode_error();
       return false;
     }
     auto p = std::get_if<std::shared_ptr<packet::Basic>>(&r);
     if (!p) return false; // impossible.
-    // Handle packet.
-    if ((*p)->is_call_request() || (*p)->is_call_notify()) {
-      if (!handle_rpc_request(conn, *p)) return false;
-    } else if ((*p)->is_call_response()) {
-      if (!handle_rpc_response(conn, *p)) return false;
-    } else if (dispatcher) {
-      if (!dispatcher(conn, *p)) return false;
-    } else if (m && m->dispatcher()) {
-      if (!m->dispatcher()(conn, *p)) return false;
-    } else {
-      LOG_WARN << get_name(conn) << " packet unhandled: " << (*p)->id();
-    }
+    if (m) m->increase_recv_packet((*p)->copied());
+    if (!dispatch(conn, std::move(*p))) return false;
     if (istream->size() == 0) break;
   }
   error_times = 0;
   return true;
 }
 
+bool Basic::Impl::dispatch(
+  Basic *conn, std::shared_ptr<packet::Basic> packet) noexcept {
+  auto m = manager.lock();
+  auto handler = m ? m->handler(packet->id()) : nullptr;
+  if (handler) {
+    if (!handler(conn, *packet)) return false;
+  } else if (packet->id() == packet::kHeartbeatId) {
+    // The input active time updated only.
+  } else if (packet->id() == packet::kRpcBatchId) {
+    if (!handle_rpc_batch(conn, std::move(packet))) return false;
+  } else if (packet->id() == packet::kRpcMethodsId) {
+    if (!handle_rpc_methods(*packet)) return false;
+  } else if (packet->is_call_request() || packet->is_call_notify()) {
+    if (!handle_rpc_request(conn, std::move(packet))) return false;
+  } else if (packet->is_call_response()) {
+    if (!handle_rpc_response(conn, std::move(packet))) return false;
+  } else if (dispatcher) {
+    if (!dispatcher(conn, std::move(packet))) return false;
+  } else if (m && m->dispatcher()) {
+    if (!m->dispatcher()(conn, std::move(packet))) return false;
+  } else {
+    LOG_WARN << get_name(conn) << " packet unhandled: " << packet->id();
+  }
+  return true;
+}
+
+bool Basic::Impl::handle_rpc_methods(packet::Basic &packet) {
+  auto methods = std::make_shared<rpc::method_table_t>();
+  uint32_t count{0};
+  packet >> count;
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string name;
+    rpc::method_id_t method_id{0};
+    packet >> name;
+    packet >> method_id;
+    if (name.empty() || method_id == 0) return false;
+    methods->emplace(std::move(name), method_id);
+  }
+  std::unique_lock<std::mutex> lock{mutex};
+  rpc_methods = std::move(methods);
+  return true;
+}
+
+// The responses sent after all requests handled(one batch and one write).
+bool Basic::Impl::handle_rpc_batch(
+  Basic *conn, std::shared_ptr<packet::Basic> packet) {
+  peer_batch.store(true, std::memory_order_relaxed);
+  auto r = stream::decode_batch(istream.get(), packet,
+    [this, conn](std::shared_ptr<packet::Basic> p) {
+      return dispatch(conn, std::move(p));
+    });
+  if (!r) LOG_ERROR << get_name(conn) << " rpc batch invalid";
+  return r;
+}
+
 bool Basic::Impl::process_exception() noexcept {
   if (!has_work_flag(WorkFlag::Except)) return true;
   return true;
@@ -232,6 +505,8 @@ bool Basic::Impl::work(Basic *conn) noexcept {
   if (!process_input(conn)) return false;
   if (!process_output(conn)) return false;
   if (!process_command(conn)) return false;
+  // The command responses flushed in this work(not wait the next).
+  if (!process_output(conn)) return false;
   return true;
 }
   
@@ -267,16 +542,11 @@ void Basic::Impl::enqueue_work() noexcept {
 }
 
 bool Basic::Impl::has_work_flag(WorkFlag flag) const noexcept {
-  std::unique_lock<std::mutex> lock{mutex};
-  return work_flags & (0x1 << std::to_underlying(flag));
+  return work_flags.load() & (0x1 << std::to_underlying(flag));
 }
   
 void Basic::Impl::set_work_flag(WorkFlag flag, bool enable) noexcept {
-  std::unique_lock<std::mutex> lock{mutex};
-  if (enable)
-    work_flags |= (0x1 << std::to_underlying(flag));
-  else
-    work_flags &= ~(0x1 << std::to_underlying(flag));
+  exchange_work_flag(flag, enable);
 #if 0
   // wait input finsh.
   if (flag == WorkFlag::Input) {
@@ -293,15 +563,12 @@ void Basic::Impl::set_work_flag(WorkFlag flag, bool enable) noexcept {
 #endif
 }
   
+// The sequential consistency for the send queue check(see process_output).
 bool Basic::Impl::exchange_work_flag(WorkFlag flag, bool enable) noexcept {
-  std::unique_lock<std::mutex> lock{mutex};
-  auto r = static_cast<bool>(work_flags & (0x1 << std::to_underlying(flag)));
-  if (r == enable) return r;
-  if (enable)
-    work_flags |= (0x1 << std::to_underlying(flag));
-  else
-    work_flags &= ~(0x1 << std::to_underlying(flag));
-  return r;
+  const uint8_t mask = 0x1 << std::to_underlying(flag);
+  auto old = enable ?
+    work_flags.fetch_or(mask) : work_flags.fetch_and(~mask & 0xff);
+  return old & mask;
 }
 
 std::string Basic::Impl::get_name(const Basic *conn) noexcept {
@@ -327,7 +594,7 @@ bool Basic::Impl::handle_rpc_request(
     auto e = get_error(r);
     int32_t error = e ? e->code() : std::to_underlying(ErrorCode::None);
     if (packet->is_call_request()) {
-      auto p = std::make_shared<packet::Basic>();
+      auto p = conn->new_packet();
       p->set_id(packet::kRpcResponseId);
       p->set_writeable(true);
       p->set_call_response(true);
@@ -358,34 +625,36 @@ bool Basic::Impl::handle_rpc_response(
   (*packet) >> index;
   if (0 == index) return true; // No call(notify?).
   (*packet) >> error;
-  auto it = callings.find(index);
-  if (it == callings.end()) {
-    LOG_WARN << "rpc response no calling: " << index << " error: " << error;
-    return false;
+  auto call = callings->take(index);
+  if (!call) { // Timeout or closed.
+    LOG_DEBUG << get_name(conn) << " rpc response no calling: " << index
+      << " error: " << error;
+    return true;
   }
-  auto &call = it->second;
-  try {
-    if (error != std::to_underlying(ErrorCode::None)) {
-      throw std::logic_error("error: " + std::to_string(error));
-    }
-    auto data = reinterpret_cast<const uint8_t *>(
-      packet->data().data() + packet->offset());
-    auto size = packet->data().size() - packet->offset();
-    std::get<1>(call).set_value(rpc::Unpacker(data, size));
-  } catch(...) {
-    std::get<1>(call).set_exception(std::current_exception());
+  if (error != std::to_underlying(ErrorCode::None)) {
+    call->promise.set_exception(std::make_exception_ptr(
+      std::logic_error("error: " + std::to_string(error))));
+    return true;
   }
+  auto data = reinterpret_cast<const uint8_t *>(
+    packet->data().data() + packet->offset());
+  auto size = packet->data().size() - packet->offset();
+  call->promise.set_result(rpc::Unpacker(packet, data, size));
   return true;
 }
   
 bool Basic::Impl::write(const std::shared_ptr<packet::Basic> &packet) noexcept {
-  stream::encode_func func{stream::encode};
-  if (codec.encode) {
-    func = codec.encode;
-  } else if (auto m = manager.lock(); m && m->codec().encode) {
-    func = m->codec().encode;
-  }
-  auto bytes = func(packet);
+  const stream::codec_t *_codec{&codec};
+  auto m = manager.lock();
+  if (!codec.encode_to && !codec.encode && m)
+    _codec = &m->codec();
+  // Encode in place into the output ring.
+  if (_codec->encode_to)
+    return _codec->encode_to(ostream.get(), *packet);
+  if (!_codec->encode)
+    return stream::encode_to(ostream.get(), *packet);
+  // The compatibility encode(bytes then copy to output).
+  auto bytes = _codec->encode(packet);
   if (bytes.empty()) return false;
   auto r = ostream->write(bytes) == bytes.size();
   return r;
@@ -411,9 +680,18 @@ bool Basic::init() noexcept {
   impl_->working.store(false, std::memory_order_relaxed);
   impl_->work_flags = 0;
   impl_->istream->clear();
-  impl_->ostream->clear();
-  impl_->callings.clear();
-  impl_->call_index = 0;
+  impl_->clear_ostream();
+  impl_->clear_send_queue();
+  impl_->want_write = false;
+  impl_->over_high_watermark = false;
+  impl_->corked = false;
+  impl_->peer_batch = false;
+  impl_->rpc_methods.reset();
+  impl_->batch.clear();
+  impl_->batch_bytes = 0;
+  impl_->input_time = 0;
+  impl_->output_time = 0;
+  impl_->callings->fail_all("interrupted");
   auto connect_call_key = get_callable_key(this, "__connect");
   s_callables.erase(connect_call_key);
   auto disconnect_call_key = get_callable_key(this, "__disconnect");
@@ -423,8 +701,7 @@ bool Basic::init() noexcept {
 }
 
 bool Basic::idle() const noexcept {
-  std::unique_lock<std::mutex> lock{impl_->mutex};
-  return !impl_->socket->valid() || (impl_->work_flags == 0);
+  return !impl_->socket->valid() || (impl_->work_flags.load() == 0);
 }
   
 bool Basic::shutdown(int32_t how) noexcept {
@@ -433,6 +710,7 @@ bool Basic::shutdown(int32_t how) noexcept {
 }
   
 bool Basic::close() noexcept {
+  impl_->callings->fail_all("connection closed");
   if (!impl_->socket->valid()) return true;
   return impl_->socket->close();
 }
@@ -477,6 +755,23 @@ void Basic::set_name(std::string_view name) noexcept {
 void Basic::set_id(id_t id) noexcept {
   impl_->id = id;
 }
+
+int32_t Basic::pull(const_byte_span_t bytes) noexcept {
+  return impl_->istream->pull(bytes);
+}
+
+void Basic::zero_copy_sent(int32_t result) noexcept {
+  // The clear may swap the ostream on other thread(the idle check).
+  while (impl_->output_busy.test_and_set(std::memory_order_seq_cst))
+    std::this_thread::yield();
+  auto sending = impl_->zero_copy_sending.load(std::memory_order_acquire);
+  if (sending && result > 0)
+    impl_->ostream->remove(static_cast<size_t>(result));
+  impl_->zero_copy_sending.store(false, std::memory_order_release);
+  impl_->output_busy.clear(std::memory_order_seq_cst);
+  auto missed = impl_->output_missed.exchange(false, std::memory_order_seq_cst);
+  if ((sending && result >= 0) || missed) enqueue_work(WorkFlag::Output);
+}
   
 std::shared_ptr<plain::net::socket::Basic> Basic::socket() const noexcept {
   return impl_->socket;
@@ -507,19 +802,63 @@ void Basic::set_disconnect_callback(callable_func func) noexcept {
 }
   
 void Basic::set_manager(std::shared_ptr<Manager> manager) noexcept {
+  impl_->istream->set_packet_pool(manager ? manager->packet_pool() : nullptr);
   impl_->manager = manager;
 }
+
+std::shared_ptr<plain::net::packet::Basic> Basic::new_packet() {
+  return impl_->istream->new_packet();
+}
+
+size_t Basic::input_size() const noexcept {
+  return impl_->istream->size();
+}
+
+size_t Basic::output_size() const noexcept {
+  return impl_->ostream->size();
+}
+
+bool Basic::writable() const noexcept {
+  return !impl_->over_high_watermark.load(std::memory_order_relaxed);
+}
+
+size_t Basic::send_queue_size() const noexcept {
+  return impl_->send_queue_size.load(std::memory_order_relaxed);
+}
   
 void Basic::set_dispatcher(packet::dispatch_func func) noexcept {
   impl_->dispatcher = func;
 }
 
+// Never block the worker, the packet encoded when the worker output.
 bool Basic::send(const std::shared_ptr<packet::Basic> &packet) noexcept {
-  std::unique_lock<std::mutex> lock{impl_->mutex};
-  auto r = impl_->write(packet);
-  lock.unlock();
-  if (r) enqueue_work(WorkFlag::Output);
-  return r;
+  if (!packet || !valid()) return false;
+  impl_->send_queue_size.fetch_add(1, std::memory_order_relaxed);
+  impl_->send_queue.push(packet);
+  if (!impl_->corked.load(std::memory_order_relaxed))
+    enqueue_work(WorkFlag::Output);
+  return true;
+}
+
+void Basic::cork() noexcept {
+  impl_->corked.store(true, std::memory_order_relaxed);
+}
+
+void Basic::uncork() noexcept {
+  if (!impl_->corked.exchange(false, std::memory_order_relaxed)) return;
+  if (!impl_->send_queue.empty()) enqueue_work(WorkFlag::Output);
+}
+
+// The connection has own codec encode the packet itself.
+bool Basic::send_encoded(
+  const std::shared_ptr<packet::Basic> &packet,
+  std::shared_ptr<const bytes_t> bytes) noexcept {
+  if (impl_->codec.encode_to || impl_->codec.encode) return send(packet);
+  if (!bytes || !valid()) return false;
+  impl_->send_queue_size.fetch_add(1, std::memory_order_relaxed);
+  impl_->send_queue.push(std::move(bytes));
+  enqueue_work(WorkFlag::Output);
+  return true;
 }
 
 void Basic::on_connect() noexcept {
@@ -528,7 +867,8 @@ void Basic::on_connect() noexcept {
   
 void Basic::on_disconnect() noexcept {
   impl_->istream->clear();
-  impl_->ostream->clear();
+  impl_->clear_ostream();
+  impl_->clear_send_queue();
   impl_->working.store(false, std::memory_order_relaxed);
   check_callable(this, "__disconnect");
 }
@@ -541,26 +881,91 @@ bool Basic::is_keep_alive() const noexcept {
   return impl_->keep_alive.load(std::memory_order_relaxed);
 }
 
-bool Basic::send_call(
+bool Basic::custom_codec() const noexcept {
+  return impl_->codec.encode_to || impl_->codec.encode;
+}
+
+void Basic::set_active_time(bool input, int64_t time) noexcept {
+  auto &value = input ? impl_->input_time : impl_->output_time;
+  value.store(time, std::memory_order_relaxed);
+}
+
+int64_t Basic::active_time(bool input) const noexcept {
+  const auto &value = input ? impl_->input_time : impl_->output_time;
+  return value.load(std::memory_order_relaxed);
+}
+
+plain::concurrency::Result<plain::net::rpc::Unpacker> Basic::send_call(
   const std::shared_ptr<packet::Basic> &packet,
-  uint32_t index, const std::string &func_name,
-  std::shared_ptr<std::promise<rpc::Unpacker>> promise) {
-  std::unique_lock<std::mutex> lock{impl_->mutex};
+  uint32_t index, std::string func_name) {
+  concurrency::ResultPromise<rpc::Unpacker> promise;
+  auto r = promise.get_result();
+  if (!packet) {
+    promise.set_exception(std::make_exception_ptr(
+      std::logic_error("async_call " + func_name + " failed")));
+    return r;
+  }
   packet->set_call_request(true);
-  auto r = impl_->write(packet);
-  if (r && static_cast<bool>(promise)) {
-    impl_->callings.emplace(
-      index, std::make_pair(func_name, std::move(*promise)));
+  auto m = impl_->manager.lock();
+  auto max_count = m ? m->setting_.rpc_call_max_count : kRpcCallMaxCount;
+  auto timeout = get_call_timeout();
+  const auto &callings = impl_->callings;
+  { // Before send, the response may be fast.
+    std::unique_lock<std::mutex> lock{callings->mutex};
+    if (max_count > 0 && callings->map.size() >= max_count) {
+      lock.unlock();
+      promise.set_exception(std::make_exception_ptr(std::logic_error(
+        "async_call " + func_name + " too many calls: " +
+        std::to_string(max_count))));
+      return r;
+    }
+    auto &call = callings->map[index];
+    call.name = func_name;
+    call.promise = std::move(promise);
+    if (timeout) {
+      // The timer fire wait the lock, so the deadline set before it.
+      try {
+        std::shared_ptr<concurrency::executor::Basic> executor =
+          ENGINE->inline_executor();
+        if (m) executor = m->get_executor();
+        call.deadline = ENGINE->timer_queue()->make_one_shot_timer(
+          std::chrono::milliseconds(*timeout), executor,
+          [weak = std::weak_ptr<Impl::callings_t>(callings), index,
+           message = "call " + func_name + " timeout: " +
+            std::to_string(*timeout)] {
+            if (auto locked = weak.lock()) locked->fail(index, message);
+          });
+      } catch (const std::exception &e) {
+        LOG_ERROR << name() << " async_call " << func_name
+          << " make deadline failed: " << e.what();
+      }
+    }
   }
-  lock.unlock();
-  if (r) enqueue_work(WorkFlag::Output);
-  // std::cout << "send_call: " << name() << std::endl;
+  if (!send(packet))
+    callings->fail(index, "async_call " + func_name + " failed");
   return r;
 }
   
+void Basic::write_method(
+  packet::Basic &packet, std::string_view name) const {
+  rpc::method_id_t id{0};
+  {
+    std::unique_lock<std::mutex> lock{impl_->mutex};
+    if (impl_->rpc_methods) {
+      auto it = impl_->rpc_methods->find(name);
+      if (it != impl_->rpc_methods->end()) id = it->second;
+    }
+  }
+  if (id == 0) {
+    packet << name;
+    return;
+  }
+  packet << uint32_t{0}; // The empty name.
+  packet << id;
+}
+
 uint32_t Basic::new_call_index() noexcept {
-  std::unique_lock<std::mutex> lock{impl_->mutex};
-  return ++(impl_->call_index);
+  return impl_->call_index.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 void Basic::set_call_timeout(const std::chrono::milliseconds &timeout) noexcept {
@@ -54,16 +54,15 @@ int32_t poll_add(data_t &d, int32_t fd, int32_t mask, id_t conn_id) {
   return r;
 }
 
-/*
-int32_t poll_mod(data_t &d, int32_t fd, int32_t mask) {
+int32_t poll_mod(data_t &d, int32_t fd, int32_t mask, id_t conn_id) {
   struct epoll_event _epoll_event;
   memset(&_epoll_event, 0, sizeof(_epoll_event));
   _epoll_event.events = mask;
-  _epoll_event.data.fd = fd;
+  _epoll_event.data.u64 =
+    touint64(static_cast<uint32_t>(fd), static_cast<uint32_t>(conn_id));
   int32_t r = epoll_ctl(d.fd, EPOLL_CTL_MOD, fd, &_epoll_event);
   return r;
 }
-*/
 
 int32_t poll_delete(data_t &d, int32_t fd) {
   struct epoll_event _epoll_event;
@@ -198,6 +197,25 @@ bool Epoll::sock_remove([[maybe_unused]] socket::id_t sock_id) noexcept {
   return false;
 }
 
+// The modify check the readiness again, so the writable socket notify once
+// even the edge passed.
+bool Epoll::sock_want_write(
+  [[maybe_unused]] socket::id_t sock_id,
+  [[maybe_unused]] connection::id_t conn_id,
+  [[maybe_unused]] bool on) noexcept {
+  assert(sock_id != socket::kInvalidId);
+#ifdef PLAIN_EPOLL_ENABLE
+  uint32_t mask = EPOLLIN | EPOLLET;
+  if (on) mask |= EPOLLOUT;
+  if (poll_mod(impl_->data, sock_id, mask, conn_id) != 0) {
+    LOG_ERROR << setting_.name << " sock_want_write error: " << strerror(errno);
+  } else {
+    return true;
+  }
+#endif
+  return false;
+}
+
 void Epoll::handle_input() noexcept {
 #ifdef PLAIN_EPOLL_ENABLE
   if (!running()) return;
@@ -215,7 +233,7 @@ void Epoll::handle_input() noexcept {
       this->accept();
     } else if (sock_id != socket::kInvalidId && sock_id == ctrl_read_fd_) {
       recv_ctrl_cmd();
-    } else if (d.events[i].events & EPOLLIN) {
+    } else if (d.events[i].events & (EPOLLIN | EPOLLOUT)) {
       if (conn_id == connection::kInvalidId)
         continue;
       auto conn = get_conn(conn_id);
@@ -233,7 +251,9 @@ void Epoll::handle_input() noexcept {
         remove(conn_id);
         continue;
       }
-      conn->enqueue_work(WorkFlag::Input);
+      if (d.events[i].events & EPOLLIN) conn->enqueue_work(WorkFlag::Input);
+      if (d.events[i].events & EPOLLOUT)
+        conn->enqueue_work(WorkFlag::Output);
     }
   }
 #endif
@@ -1,16 +1,19 @@
 #include "plain/net/connection/io_uring.h"
 #if __has_include(<liburing.h>)
 #include <liburing.h>
-#include <sys/eventfd.h>
-#include <sys/utsname.h>
 #include <sys/poll.h>
-// #define PLAIN_LIBURING_ENABLE
+#include <sys/socket.h>
+#else
+#undef PLAIN_LIBURING_ENABLE
 #endif
+#include <unordered_map>
 #include "plain/basic/logger.h"
+#include "plain/basic/mpsc_queue.h"
 #include "plain/basic/utility.h"
+#include "plain/net/connection/basic.h"
+#include "plain/net/socket/basic.h"
 
 using plain::net::connection::IoUring;
-using plain::net::detail::Awaitable;
 
 #ifndef PLAIN_LIBURING_ENABLE
 
@@ -53,13 +56,18 @@ bool IoUring::sock_remove(socket::id_t) noexcept {
 void IoUring::handle_input() noexcept {
 
 }
-  
-void *IoUring::get_sock_data() noexcept {
-  return nullptr;
+
+void IoUring::handle_recv(io_uring_cqe *, uint32_t, connection::id_t) noexcept {
+
+}
+
+bool IoUring::send_zero_copy(
+  Basic *, const_byte_span_t, std::shared_ptr<const void>) noexcept {
+  return false;
 }
 
-plain::net::detail::Task<int32_t> IoUring::accept_await() noexcept {
-  co_return 1;
+void IoUring::handle_send(io_uring_cqe *, uint32_t, connection::id_t) noexcept {
+
 }
 #else
 
@@ -71,33 +79,81 @@ plain::net::detail::Task<int32_t> IoUring::accept_await() noexcept {
 #define printf_if_verbose(...)
 #endif
 
+namespace {
+
+// The request type in the user data(type << 56 | sequence << 32 | conn id).
+enum class Op : uint8_t {
+  Accept = 1,
+  Recv = 2,
+  Ctrl = 3,
+  Cancel = 4,
+  SendZeroCopy = 5,
+};
+
+constexpr uint16_t kBufferGroupId{1};
+constexpr uint32_t kBufferCount{1024}; // The power of 2.
+constexpr uint32_t kBufferSize{4096};
+
+uint64_t make_data(Op op, uint32_t sequence, int32_t id) noexcept {
+  return static_cast<uint64_t>(op) << 56 |
+    static_cast<uint64_t>(sequence & 0xffffff) << 32 |
+    static_cast<uint32_t>(id);
+}
+
+}
+
 struct IoUring::Impl {
-  Impl();
+  // The registered file of a connection, the sequence drop the completions
+  // of the removed one(the id and index will reuse).
+  struct file_struct {
+    socket::id_t sock_id{socket::kInvalidId};
+    int32_t index{-1};
+    uint32_t sequence{0};
+    int32_t sent{0}; // The zero copy send result(wait the notification).
+  };
+  using file_t = file_struct;
+  struct pending_struct {
+    bool add{true};
+    socket::id_t sock_id{socket::kInvalidId};
+    connection::id_t conn_id{connection::kInvalidId};
+  };
+  using pending_t = pending_struct;
   ~Impl();
   struct io_uring ring;
-  uint32_t cqe_count{0};
   bool ready{false};
+  bool zero_copy{false}; // SEND_ZC supported.
+  io_uring_buf_ring *buffer_ring{nullptr};
+  std::unique_ptr<std::byte[]> buffers;
+  // Only the ring(worker) thread use them, the others push to pending.
+  std::unordered_map<connection::id_t, file_t> files;
+  std::unordered_map<socket::id_t, connection::id_t> conn_ids;
+  std::vector<int32_t> free_indexes;
+  uint32_t sequence{0};
+  // The zero copy sending bytes owners by the request user data, released
+  // on the last completion even the connection removed.
+  std::unordered_map<uint64_t, std::shared_ptr<const void>> zero_copy_owners;
+  MpscQueue<pending_t> pending;
+  // The connections(id and sequence) wait the buffers back to recv again.
+  std::vector<std::pair<connection::id_t, uint32_t>> starved;
   static std::array<bool, IORING_OP_LAST> probe_ops;
-  static Awaitable await_work(io_uring_sqe *sqe, uint8_t flags);
   void test_uring_op(const io_uring_params &params) noexcept;
   [[nodiscard]] struct io_uring_sqe *get_sqe() noexcept;
-  bool submit() noexcept;
+  bool init_buffers() noexcept;
+  void recycle_buffer(uint32_t buffer_id) noexcept;
+  bool accept(socket::id_t sock_id) noexcept;
+  bool poll(socket::id_t sock_id) noexcept;
+  bool recv(connection::id_t conn_id, const file_t &file) noexcept;
+  bool add(socket::id_t sock_id, connection::id_t conn_id) noexcept;
+  bool remove(socket::id_t sock_id) noexcept;
 };
 
 std::array<bool, IORING_OP_LAST> IoUring::Impl::probe_ops = {};
 
-IoUring::Impl::Impl() = default;
-
 IoUring::Impl::~Impl() {
-  if (ready) io_uring_queue_exit(&ring);
-}
-
-Awaitable IoUring::Impl::await_work(io_uring_sqe *sqe, uint8_t flags = 0) {
-  io_uring_sqe_set_flags(sqe, flags);
-  auto resolve = [sqe](void *data) {
-    io_uring_sqe_set_data(sqe, data);
-  };
-  return Awaitable(resolve);
+  if (!ready) return;
+  if (buffer_ring)
+    io_uring_free_buf_ring(&ring, buffer_ring, kBufferCount, kBufferGroupId);
+  io_uring_queue_exit(&ring);
 }
 
 void IoUring::Impl::test_uring_op(const io_uring_params &params) noexcept {
@@ -190,20 +246,107 @@ struct io_uring_sqe *IoUring::Impl::get_sqe() noexcept {
   auto r = io_uring_get_sqe(&ring);
   if (!!r) [[likely]]
     return r;
+  // The queue full, submit the prepared.
+  auto error = io_uring_submit(&ring);
+  if (error < 0) {
+    LOG_ERROR << "io_uring_submit error: " << -error;
+    return nullptr;
+  }
+  return io_uring_get_sqe(&ring);
+}
 
-  if (submit())
-    r = io_uring_get_sqe(&ring);
-  return r;
+bool IoUring::Impl::init_buffers() noexcept {
+  int32_t error{0};
+  buffer_ring = io_uring_setup_buf_ring(
+    &ring, kBufferCount, kBufferGroupId, 0, &error);
+  if (!buffer_ring) {
+    LOG_ERROR << "io_uring_setup_buf_ring error: " << -error;
+    return false;
+  }
+  buffers = std::make_unique<std::byte[]>(kBufferCount * kBufferSize);
+  auto mask = io_uring_buf_ring_mask(kBufferCount);
+  for (uint32_t i = 0; i < kBufferCount; ++i) {
+    io_uring_buf_ring_add(
+      buffer_ring, buffers.get() + i * kBufferSize, kBufferSize,
+      static_cast<uint16_t>(i), mask, static_cast<int32_t>(i));
+  }
+  io_uring_buf_ring_advance(buffer_ring, kBufferCount);
+  return true;
 }
 
-bool IoUring::Impl::submit() noexcept {
-  io_uring_cq_advance(&ring, cqe_count);
-  cqe_count = 0;
-  auto error = io_uring_submit(&ring);
+void IoUring::Impl::recycle_buffer(uint32_t buffer_id) noexcept {
+  io_uring_buf_ring_add(
+    buffer_ring, buffers.get() + buffer_id * kBufferSize, kBufferSize,
+    static_cast<uint16_t>(buffer_id), io_uring_buf_ring_mask(kBufferCount), 0);
+  io_uring_buf_ring_advance(buffer_ring, 1);
+}
+
+bool IoUring::Impl::accept(socket::id_t sock_id) noexcept {
+  auto sqe = get_sqe();
+  if (!sqe) return false;
+  io_uring_prep_multishot_accept(sqe, sock_id, nullptr, nullptr, 0);
+  io_uring_sqe_set_data64(sqe, make_data(Op::Accept, 0, 0));
+  return true;
+}
+
+bool IoUring::Impl::poll(socket::id_t sock_id) noexcept {
+  auto sqe = get_sqe();
+  if (!sqe) return false;
+  io_uring_prep_poll_multishot(sqe, sock_id, POLLIN);
+  io_uring_sqe_set_data64(sqe, make_data(Op::Ctrl, 0, 0));
+  return true;
+}
+
+bool IoUring::Impl::recv(
+  connection::id_t conn_id, const file_t &file) noexcept {
+  auto sqe = get_sqe();
+  if (!sqe) return false;
+  io_uring_prep_recv_multishot(sqe, file.index, nullptr, 0, 0);
+  io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT);
+  sqe->buf_group = kBufferGroupId;
+  io_uring_sqe_set_data64(sqe, make_data(Op::Recv, file.sequence, conn_id));
+  return true;
+}
+
+bool IoUring::Impl::add(
+  socket::id_t sock_id, connection::id_t conn_id) noexcept {
+  if (free_indexes.empty()) {
+    LOG_ERROR << "no free file index: " << sock_id;
+    return false;
+  }
+  auto index = free_indexes.back();
+  auto error = io_uring_register_files_update(
+    &ring, static_cast<uint32_t>(index), &sock_id, 1);
   if (error < 0) {
-    LOG_ERROR << "error: " << -error;
+    LOG_ERROR << "io_uring_register_files_update error: " << -error;
     return false;
   }
+  free_indexes.pop_back();
+  auto &file = files[conn_id];
+  file = {sock_id, index, ++sequence};
+  conn_ids[sock_id] = conn_id;
+  return recv(conn_id, file);
+}
+
+bool IoUring::Impl::remove(socket::id_t sock_id) noexcept {
+  auto it = conn_ids.find(sock_id);
+  if (it == conn_ids.end()) return false;
+  auto conn_id = it->second;
+  conn_ids.erase(it);
+  auto file_it = files.find(conn_id);
+  if (file_it == files.end()) return false;
+  auto file = file_it->second;
+  files.erase(file_it);
+  auto sqe = get_sqe();
+  if (sqe) {
+    io_uring_prep_cancel64(
+      sqe, make_data(Op::Recv, file.sequence, conn_id), 0);
+    io_uring_sqe_set_data64(sqe, make_data(Op::Cancel, 0, 0));
+  }
+  int32_t invalid_fd{-1};
+  io_uring_register_files_update(
+    &ring, static_cast<uint32_t>(file.index), &invalid_fd, 1);
+  free_indexes.push_back(file.index);
   return true;
 }
 
@@ -211,42 +354,58 @@ IoUring::IoUring(
   const setting_t &setting,
   std::shared_ptr<concurrency::executor::Basic> executor) :
   Manager(setting, executor), impl_{std::make_unique<Impl>()} {
-
+  // The completions fill the input streams in the ring thread, so the
+  // connections must work in it too.
+  set_reactor(true);
 }
 
 IoUring::~IoUring() = default;
 
 bool IoUring::prepare() noexcept {
-  io_uring_params params {
-    .flags = 0,
-    .wq_fd = 0
-  };
+  if (running()) return true;
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
   int32_t error{0};
   if ((error = io_uring_queue_init_params(
       setting_.max_count, &impl_->ring, &params)) < 0) {
-    LOG_ERROR << "io_uring_queue_init_params error: " << -error;
+    LOG_ERROR << setting_.name << " io_uring_queue_init_params error: "
+      << -error;
     return false;
   }
-  impl_->test_uring_op(params);
   impl_->ready = true;
+  impl_->test_uring_op(params);
+  impl_->zero_copy = Impl::probe_ops[IORING_OP_SEND_ZC];
+  if ((error = io_uring_register_files_sparse(
+      &impl_->ring, setting_.max_count)) < 0) {
+    LOG_ERROR << setting_.name << " io_uring_register_files_sparse error: "
+      << -error;
+    return false;
+  }
+  impl_->free_indexes.reserve(setting_.max_count);
+  for (auto i = static_cast<int32_t>(setting_.max_count) - 1; i >= 0; --i)
+    impl_->free_indexes.emplace_back(i);
+  if (!impl_->init_buffers()) return false;
+  if (listen_fd_ != socket::kInvalidId && !impl_->accept(listen_fd_))
+    return false;
   return true;
 }
 
 bool IoUring::work() noexcept {
-  for (;;) {
-    accept_await(); // accept.
-                    // recv ?
-    io_uring_submit_and_wait(&impl_->ring, 1);
-    io_uring_cqe *cqe{nullptr};
-    uint32_t head{0};
-    io_uring_for_each_cqe(&impl_->ring, head, cqe) {
-      ++impl_->cqe_count;
-      auto coro =
-        static_cast<net::detail::Resolver *>(io_uring_cqe_get_data(cqe));
-      if (coro) coro->resolve(cqe->res);
+  impl_->pending.consume([this](Impl::pending_t pending) {
+    if (pending.add) {
+      sock_add(pending.sock_id, pending.conn_id);
+    } else {
+      sock_remove(pending.sock_id);
     }
-    if (!running()) break;
+  });
+  // The requests prepared in the last loop submit with the wait.
+  auto error = io_uring_submit_and_wait(&impl_->ring, 1);
+  if (error < 0 && error != -EINTR) {
+    LOG_ERROR << setting_.name << " io_uring_submit_and_wait error: "
+      << -error;
+    return false;
   }
+  handle_input();
   return true;
 }
 
@@ -256,33 +415,177 @@ void IoUring::off() noexcept {
 
 bool IoUring::sock_add(
   socket::id_t sock_id, connection::id_t conn_id) noexcept {
-  auto sqe = impl_->get_sqe();
-  io_uring_prep_poll_add(sqe, sock_id, POLLIN);
-  return true;
+  assert(sock_id != socket::kInvalidId);
+  if (!in_worker()) { // Add in the ring thread.
+    impl_->pending.push({true, sock_id, conn_id});
+    send_ctrl_cmd("w");
+    return true;
+  }
+  if (sock_id == ctrl_read_fd_) return impl_->poll(sock_id);
+  return impl_->add(sock_id, conn_id);
 }
 
 bool IoUring::sock_remove(socket::id_t sock_id) noexcept {
+  assert(sock_id != socket::kInvalidId);
+  if (!in_worker()) {
+    impl_->pending.push({false, sock_id, connection::kInvalidId});
+    send_ctrl_cmd("w");
+    return true;
+  }
+  return impl_->remove(sock_id);
+}
+
+bool IoUring::send_zero_copy(
+  Basic *conn, const_byte_span_t bytes,
+  std::shared_ptr<const void> owner) noexcept {
+  assert(conn);
+  if (!impl_->zero_copy || !in_worker()) return false;
+  auto it = impl_->files.find(conn->id());
+  if (it == impl_->files.end()) return false;
   auto sqe = impl_->get_sqe();
-  io_uring_prep_poll_remove(sqe, sock_id);
+  if (!sqe) return false;
+  auto &file = it->second;
+  io_uring_prep_send_zc(
+    sqe, file.index, bytes.data(), bytes.size(), MSG_NOSIGNAL, 0);
+  io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+  auto data = make_data(Op::SendZeroCopy, file.sequence, conn->id());
+  io_uring_sqe_set_data64(sqe, data);
+  impl_->zero_copy_owners[data] = std::move(owner);
+  file.sent = 0;
   return true;
 }
 
 void IoUring::handle_input() noexcept {
-
+  auto &ring = impl_->ring;
+  io_uring_cqe *cqe{nullptr};
+  uint32_t head{0};
+  uint32_t count{0};
+  io_uring_for_each_cqe(&ring, head, cqe) {
+    ++count;
+    auto data = io_uring_cqe_get_data64(cqe);
+    auto op = static_cast<Op>(data >> 56);
+    auto sequence = static_cast<uint32_t>(data >> 32) & 0xffffff;
+    auto conn_id = static_cast<connection::id_t>(data & 0xffffffff);
+    auto more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    switch (op) {
+      case Op::Accept:
+        if (cqe->res >= 0) {
+          accept(static_cast<socket::id_t>(cqe->res));
+        } else if (cqe->res != -ECANCELED) {
+          LOG_ERROR << setting_.name << " accept error: " << -cqe->res;
+        }
+        if (!more && running()) impl_->accept(listen_fd_);
+        break;
+      case Op::Ctrl:
+        recv_ctrl_cmd();
+        if (!more && running()) impl_->poll(ctrl_read_fd_);
+        break;
+      case Op::Recv:
+        handle_recv(cqe, sequence, conn_id);
+        break;
+      case Op::SendZeroCopy:
+        handle_send(cqe, sequence, conn_id);
+        break;
+      default:
+        break;
+    }
+  }
+  io_uring_cq_advance(&ring, count);
+  // The buffers consumed before the ENOBUFS all recycled now(the completions
+  // in order), the new ones come with the next batch, so not spin on the
+  // empty buffer ring.
+  if (impl_->starved.empty()) return;
+  decltype(impl_->starved) starved;
+  std::swap(starved, impl_->starved);
+  for (auto [conn_id, sequence] : starved) {
+    auto it = impl_->files.find(conn_id);
+    if (it != impl_->files.end() && it->second.sequence == sequence)
+      impl_->recv(conn_id, it->second);
+  }
 }
 
-void *IoUring::get_sock_data() noexcept {
-  return impl_->get_sqe();
+void IoUring::handle_recv(
+  io_uring_cqe *cqe, uint32_t sequence, connection::id_t conn_id) noexcept {
+  auto res = cqe->res;
+  auto more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+  const_byte_span_t bytes;
+  uint32_t buffer_id{kBufferCount};
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    buffer_id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    if (res > 0) {
+      bytes = {
+        impl_->buffers.get() + buffer_id * kBufferSize,
+        static_cast<size_t>(res)
+      };
+    }
+  }
+  // The data copied to the input stream, the buffer back to the ring.
+  scoped_executor_t recycle([this, buffer_id]() {
+    if (buffer_id < kBufferCount) impl_->recycle_buffer(buffer_id);
+  });
+  auto it = impl_->files.find(conn_id);
+  if (it == impl_->files.end() || it->second.sequence != sequence)
+    return; // Removed.
+  auto conn = get_conn(conn_id);
+  if (!conn) {
+    LOG_ERROR << setting_.name << " can't find connection: " << conn_id;
+    return;
+  }
+  if (res == -ENOBUFS) { // The buffers used up, armed after the batch.
+    if (!more) impl_->starved.emplace_back(conn_id, sequence);
+    return;
+  }
+  if (res <= 0) {
+    if (res < 0 && res != -ECANCELED)
+      LOG_ERROR << setting_.name << " recv error: " << -res;
+    remove(conn);
+    return;
+  }
+  auto r = conn->pull(bytes);
+  if (r < 0) {
+    LOG_ERROR << conn->name() << " pull failed: " << r;
+    remove(conn);
+    return;
+  }
+  increase_recv_size(static_cast<size_t>(r));
+  conn->set_active_time(true, idle_clock());
+  conn->enqueue_work(WorkFlag::Command);
+  if (!more) impl_->recv(conn_id, it->second);
 }
 
-plain::net::detail::Task<int32_t>
-IoUring::accept_await() noexcept {
-  auto sqe = impl_->get_sqe();
-  io_uring_prep_accept(sqe, listen_fd_, nullptr, nullptr, 0);
-  auto fd = co_await impl_->await_work(sqe);
-  if (fd != socket::kInvalidId) {
-    accept(fd);
+// The first completion have the result, the bytes can reuse after the
+// notification(IORING_CQE_F_NOTIF) completion.
+void IoUring::handle_send(
+  io_uring_cqe *cqe, uint32_t sequence, connection::id_t conn_id) noexcept {
+  scoped_executor_t release([this, cqe]() {
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+      impl_->zero_copy_owners.erase(io_uring_cqe_get_data64(cqe));
+  });
+  auto it = impl_->files.find(conn_id);
+  if (it == impl_->files.end() || it->second.sequence != sequence)
+    return; // Removed.
+  auto &file = it->second;
+  if (!(cqe->flags & IORING_CQE_F_NOTIF)) {
+    file.sent = cqe->res;
+    if (cqe->flags & IORING_CQE_F_MORE) return;
+  }
+  auto conn = get_conn(conn_id);
+  if (!conn) return;
+  auto sent = file.sent;
+  if (sent == -EOPNOTSUPP) { // Send normally from now on.
+    impl_->zero_copy = false;
+    sent = 0;
+  }
+  if (sent < 0) {
+    LOG_ERROR << conn->name() << " send zero copy error: " << -sent;
+    conn->zero_copy_sent(sent);
+    remove(conn);
+    return;
   }
+  increase_send_size(static_cast<size_t>(sent));
+  increase_send_zero_copy(static_cast<size_t>(sent));
+  if (sent > 0) conn->set_active_time(false, idle_clock());
+  conn->zero_copy_sent(sent);
 }
 
 #endif
@@ -4,15 +4,21 @@
 #include <deque>
 #include <map>
 #include <latch>
+#include <optional>
 #include "plain/basic/utility.h"
+#include "plain/basic/mpsc_queue.h"
 #include "plain/concurrency/executor/basic.h"
 #include "plain/concurrency/executor/worker_thread.h"
 #include "plain/engine/kernel.h"
+#include "plain/engine/timer_queue.h"
 #include "plain/net/detail/coroutine.h"
 #include "plain/net/connection/basic.h"
+#include "plain/net/packet/pool.h"
+#include "plain/net/rpc/dispatcher.h"
 #include "plain/net/socket/api.h"
 #include "plain/net/socket/basic.h"
 #include "plain/net/socket/listener.h"
+#include "plain/net/stream/basic.h"
 
 // Current coroutine implemention not recommand.
 // #define PLAIN_NET_MANAGER_ENABLE_COROUTINE
@@ -23,20 +29,111 @@ using namespace std::chrono_literals;
 namespace plain::net::connection::detail {
 namespace {
 
+// The connection slot read without lock, the conn created once and published
+// by the raw pointer. The generation is odd when the slot in use.
+struct ConnectionSlot {
+  std::atomic<plain::net::connection::Basic *> raw{nullptr};
+  std::shared_ptr<plain::net::connection::Basic> conn;
+  std::atomic_uint32_t generation{0};
+  std::atomic<id_t> next_free{0};
+};
+
+// Fixed capacity(the max count) slots and a lock free free list(the head
+// tagged with a counter for ABA). The ids begin from base + 1(the listener
+// reactors have the different base), the slots and the free list use the
+// local id(id - base).
 struct ConnectionInfo {
-  std::vector<std::shared_ptr<plain::net::connection::Basic>> list;
-  std::shared_ptr<std::set<id_t>> ids; // The valid ids.
-  std::set<id_t> free_ids;
-  size_t size{0};
-  id_t max_id{0};
+  std::unique_ptr<ConnectionSlot[]> slots;
+  size_t capacity{0};
+  id_t base{0};
+  std::atomic_uint64_t free_head{0}; // tag << 32 | local id(0 is empty)
+  std::atomic<id_t> max_id{0}; // The max local id.
+  std::atomic_size_t size{0};
+  size_t index(id_t id) const noexcept {
+    return static_cast<size_t>(id - base) - 1; // Invalid ids out of range.
+  }
+  std::shared_ptr<plain::net::connection::Basic>
+  get(id_t id) const noexcept;
+  std::shared_ptr<plain::net::connection::Basic> get_or_create(id_t id);
+  bool in_use(id_t id) const noexcept;
+  void push_free(id_t id) noexcept;
+  id_t pop_free() noexcept;
 };
 
+std::shared_ptr<plain::net::connection::Basic>
+ConnectionInfo::get(id_t id) const noexcept {
+  auto i = index(id);
+  if (i >= capacity) return {};
+  auto &slot = slots[i];
+  if (!slot.raw.load(std::memory_order_acquire)) return {};
+  return slot.conn;
+}
+
+// Only the slot owner(new conn) create it.
+std::shared_ptr<plain::net::connection::Basic>
+ConnectionInfo::get_or_create(id_t id) {
+  auto &slot = slots[index(id)];
+  if (!slot.raw.load(std::memory_order_acquire)) {
+    slot.conn = std::make_shared<plain::net::connection::Basic>();
+    slot.raw.store(slot.conn.get(), std::memory_order_release);
+  }
+  return slot.conn;
+}
+
+bool ConnectionInfo::in_use(id_t id) const noexcept {
+  auto i = index(id);
+  if (i >= capacity) return false;
+  return slots[i].generation.load(std::memory_order_acquire) & 0x1;
+}
+
+void ConnectionInfo::push_free(id_t id) noexcept {
+  auto &slot = slots[index(id)];
+  auto local_id = static_cast<uint32_t>(id - base);
+  auto head = free_head.load(std::memory_order_relaxed);
+  for (;;) {
+    slot.next_free.store(
+      static_cast<id_t>(head & 0xffffffff), std::memory_order_relaxed);
+    uint64_t next = ((head >> 32) + 1) << 32 | local_id;
+    if (free_head.compare_exchange_weak(
+      head, next, std::memory_order_release, std::memory_order_relaxed))
+      break;
+  }
+}
+
+id_t ConnectionInfo::pop_free() noexcept {
+  auto head = free_head.load(std::memory_order_acquire);
+  for (;;) {
+    auto local_id = static_cast<id_t>(head & 0xffffffff);
+    if (local_id == 0) return kInvalidId;
+    auto next_id = slots[static_cast<size_t>(local_id) - 1].next_free.load(
+      std::memory_order_relaxed);
+    uint64_t next = ((head >> 32) + 1) << 32 | static_cast<uint32_t>(next_id);
+    if (free_head.compare_exchange_weak(
+      head, next, std::memory_order_acquire, std::memory_order_acquire))
+      return base + local_id;
+  }
+}
+
+// The traffic counters padded per thread, sum them when read.
+struct alignas(kCacheInlineAlignment) TrafficCounter {
+  std::atomic_uint64_t send_size{0};
+  std::atomic_uint64_t recv_size{0};
+  std::atomic_uint64_t send_packet_count{0};
+  std::atomic_uint64_t recv_packet_count{0};
+  std::atomic_uint64_t recv_copy_size{0};
+  std::atomic_uint64_t decode_error_count{0};
+  std::atomic_uint64_t send_zero_copy_size{0};
+};
+
+static constexpr size_t kTrafficCounterCount{16};
+
 }
 }
 
 struct Manager::Impl {
   stream::codec_t codec;
   packet::dispatch_func dispatcher;
+  std::vector<packet::handler_func> handlers; // Index by packet id.
   std::shared_ptr<concurrency::executor::Basic> executor;
   detail::ConnectionInfo connection_info;
   std::recursive_mutex mutex; // callback will recursive use this mutex(
@@ -51,21 +148,44 @@ struct Manager::Impl {
   std::atomic_bool running{false};
   callable_func connect_callback;
   callable_func disconnect_callback;
-  uint64_t send_size{0};
-  uint64_t recv_size{0};
+  callable_func high_watermark_callback;
+  callable_func low_watermark_callback;
+  std::array<detail::TrafficCounter, detail::kTrafficCounterCount> counters;
+  std::shared_ptr<packet::Pool> packet_pool;
   // This values for enqueue connection works.
   std::atomic_uint32_t working_conn_count{0};
   std::deque<connection::id_t> wait_work_conn_id_deque;
   std::set<connection::id_t> wait_work_conn_ids;
   int32_t working_conn_max_count{32};
   std::latch latch{1};
+#ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
+  // The reactor(listener reactor_count > 1) works the connections in the
+  // worker thread, the other threads push the ids and wake it up.
+  bool reactor{false};
+  std::thread::id worker_id;
+  std::deque<connection::id_t> reactor_ids; // Only the worker thread.
+  MpscQueue<connection::id_t> reactor_remote_ids;
+  std::atomic_bool reactor_wakeup{false};
+#endif
 
   // rpc.
   std::shared_ptr<rpc::Dispatcher> rpc_dispatcher;
 
-  void init_connections(uint32_t count);
+  // The idle check.
+  std::atomic_int64_t idle_clock{0};
+  int64_t idle_check_interval{0};
+  Timer idle_timer;
+  std::shared_ptr<packet::Basic> heartbeat;
+
+  std::shared_ptr<const bytes_t>
+  encode(const std::shared_ptr<packet::Basic> &packet) const;
+  void init_connections(uint32_t capacity, uint32_t count);
+  detail::TrafficCounter &counter() noexcept;
+  uint64_t
+  sum(std::atomic_uint64_t detail::TrafficCounter::*field) const noexcept;
 #ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
   static bool wait_work(std::shared_ptr<Manager> manager) noexcept;
+  static void reactor_work(std::shared_ptr<Manager> manager) noexcept;
 #else
   static void enqueue_work_await(std::shared_ptr<Manager> manager) noexcept;
   static plain::net::detail::Task<bool>
@@ -75,19 +195,58 @@ struct Manager::Impl {
     std::shared_ptr<Manager> manager, connection::id_t conn_id) noexcept;
   connection::id_t pop_work_id() noexcept;
   void push_work_id(connection::id_t id) noexcept;
+  void start_idle_check(std::shared_ptr<Manager> manager);
+  void send_rpc_methods(Basic *conn) const noexcept;
+  static int64_t now() noexcept;
+  // The generation(if set) compared under the lock, so the slot reused by
+  // the new connection not removed.
+  static void remove(
+    Manager *manager, connection::id_t conn_id, bool no_event, bool sock,
+    std::optional<uint32_t> expected) noexcept;
 
 };
 
-void Manager::Impl::init_connections(uint32_t count) {
-  connection_info.list.reserve(count);
-  for (uint32_t i = 0; i < count; ++i) {
-    auto ptr = std::make_shared<Basic>();
+plain::net::connection::detail::TrafficCounter &
+Manager::Impl::counter() noexcept {
+  static std::atomic_size_t next{0};
+  thread_local size_t index{
+    next.fetch_add(1, std::memory_order_relaxed) %
+    detail::kTrafficCounterCount};
+  return counters[index];
+}
+
+uint64_t Manager::Impl::sum(
+  std::atomic_uint64_t detail::TrafficCounter::*field) const noexcept {
+  uint64_t r{0};
+  for (const auto &counter : counters)
+    r += (counter.*field).load(std::memory_order_relaxed);
+  return r;
+}
+
+// The empty is failed.
+std::shared_ptr<const plain::bytes_t>
+Manager::Impl::encode(const std::shared_ptr<packet::Basic> &packet) const {
+  bytes_t bytes;
+  if (codec.encode_to) {
+    stream::Basic output{nullptr};
+    if (!codec.encode_to(&output, *packet)) return {};
+    bytes.resize(output.size());
+    output.read(bytes);
+  } else if (codec.encode) {
+    bytes = codec.encode(packet);
+  } else {
+    bytes = stream::encode(packet);
+  }
+  if (bytes.empty()) return {};
+  return std::make_shared<const bytes_t>(std::move(bytes));
+}
+
+void Manager::Impl::init_connections(uint32_t capacity, uint32_t count) {
+  connection_info.slots = std::make_unique<detail::ConnectionSlot[]>(capacity);
+  connection_info.capacity = capacity;
+  for (uint32_t i = 0; i < count && i < capacity; ++i) {
+    auto ptr = connection_info.get_or_create(static_cast<id_t>(i + 1));
     ptr->init();
-    connection_info.list.emplace_back(ptr);
-    /*
-    connection_info.list[i] = ptr;
-    connection_info.list[i]->init();
-    */
   }
 }
 
@@ -147,8 +306,32 @@ bool Manager::Impl::wait_work(std::shared_ptr<Manager> manager) noexcept {
   }
   if (!manager->running() || !manager->work()) return false;
   // std::this_thread::sleep_for(1ms); // change to executor thread work.
+  if (manager->impl_->reactor) reactor_work(manager);
   return true;
 }
+
+void Manager::Impl::reactor_work(std::shared_ptr<Manager> manager) noexcept {
+  auto &impl = *manager->impl_;
+  impl.reactor_wakeup.store(false, std::memory_order_seq_cst);
+  impl.reactor_remote_ids.consume([&impl](connection::id_t id) {
+    impl.reactor_ids.push_back(id);
+  });
+  // The not idle connections work again after the next poll.
+  for (auto count = impl.reactor_ids.size(); count > 0; --count) {
+    auto id = impl.reactor_ids.front();
+    impl.reactor_ids.pop_front();
+    auto conn = manager->get_conn(id);
+    if (!conn || !conn->valid()) continue;
+    if (!conn->work()) {
+      manager->remove(conn);
+    } else if (!conn->idle()) {
+      impl.reactor_ids.push_back(id);
+    }
+  }
+  if (!impl.reactor_ids.empty() &&
+      !impl.reactor_wakeup.exchange(true, std::memory_order_seq_cst))
+    manager->send_ctrl_cmd("w");
+}
 #endif
 
 void Manager::Impl::work(
@@ -202,6 +385,52 @@ void Manager::Manager::Impl::push_work_id(connection::id_t id) noexcept {
   wait_work_conn_ids.emplace(id);
 }
 
+int64_t Manager::Impl::now() noexcept {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Manager::Impl::start_idle_check(std::shared_ptr<Manager> manager) {
+  const auto &setting = manager->setting_;
+  uint32_t min{0};
+  for (auto value : {setting.read_idle_timeout, setting.write_idle_timeout,
+    setting.heartbeat_interval}) {
+    if (value > 0 && (min == 0 || value < min)) min = value;
+  }
+  idle_clock.store(now(), std::memory_order_relaxed);
+  if (min == 0) return;
+  if (setting.heartbeat_interval > 0) {
+    heartbeat = std::make_shared<packet::Basic>();
+    heartbeat->set_id(packet::kHeartbeatId);
+  }
+  idle_check_interval =
+    std::clamp(min / 4, kIdleCheckIntervalMin, kIdleCheckIntervalMax);
+  auto interval = std::chrono::milliseconds(idle_check_interval);
+  idle_timer = ENGINE->timer_queue()->make_timer(
+    interval, interval, executor,
+    [weak = std::weak_ptr<Manager>(manager)] {
+      if (auto m = weak.lock()) m->check_idle();
+    });
+}
+
+// The peer call with the method ids after it received(the default codec).
+void Manager::Impl::send_rpc_methods(Basic *conn) const noexcept {
+  if (!rpc_dispatcher || codec.encode_to || codec.encode) return;
+  if (conn->custom_codec()) return;
+  const auto &methods = rpc_dispatcher->methods();
+  if (methods.empty()) return;
+  auto packet = conn->new_packet();
+  packet->set_id(packet::kRpcMethodsId);
+  packet->set_writeable(true);
+  *packet << static_cast<uint32_t>(methods.size());
+  for (const auto &[name, id] : methods) {
+    *packet << name;
+    *packet << id;
+  }
+  packet->set_writeable(false);
+  conn->send(packet);
+}
+
 Manager::Manager(
   const setting_t &setting,
   std::shared_ptr<concurrency::executor::Basic> executor) :
@@ -210,13 +439,20 @@ Manager::Manager(
     throw std::runtime_error("socket initialize failed");
   assert(setting.default_count <= setting.max_count);
   if (!executor) {
-    executor = std::make_shared<concurrency::executor::WorkerThread>();
+    executor = std::make_shared<concurrency::executor::WorkerThread>(
+      nullptr, nullptr, concurrency::wait_policy_t{}, setting.cpus);
   }
   impl_->executor = executor;
-  impl_->init_connections(setting.default_count);
+  if (setting.packet_pool_size > 0) {
+    impl_->packet_pool =
+      std::make_shared<packet::Pool>(setting.packet_pool_size);
+  }
+  impl_->init_connections(setting.max_count, setting.default_count);
+#ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
+  impl_->reactor = setting.reactor_count > 1;
+#endif
   impl_->working_conn_max_count = impl_->executor->max_concurrency_level();
   if (impl_->working_conn_max_count > 0) impl_->working_conn_max_count *= 2;
-  impl_->connection_info.ids = std::make_shared<std::set<connection::id_t>>();
 }
 
 Manager::~Manager() {
@@ -244,16 +480,20 @@ bool Manager::start() {
   ENGINE->add(shared_from_this());
 #ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
    impl_->worker = thread_t([manager = shared_from_this()]{
+    if (!manager->setting_.cpus.empty())
+      thread::set_affinity(manager->setting_.cpus);
     manager->impl_->latch.wait();
     for (;;) {
       if (!Impl::wait_work(manager)) break;
     }
     // std::cout << "work exit: " << manager << std::endl;
   });
+  impl_->worker_id = impl_->worker.get_id();
 #else
   impl_->enqueue_work_await(shared_from_this());
 #endif
   impl_->running.store(true, std::memory_order_relaxed);
+  impl_->start_idle_check(shared_from_this());
   impl_->latch.count_down();
   return true;
 }
@@ -264,8 +504,11 @@ void Manager::stop() {
   if (!running) return;
   if (setting_.name != "console") // console is kernel owner
     ENGINE->remove_net(setting_.name);
+  impl_->idle_timer.cancel();
   off();
-  for (auto conn : impl_->connection_info.list) {
+  const auto &info = impl_->connection_info;
+  for (id_t id = info.base + 1; id <= info.base + info.max_id; ++id) {
+    auto conn = info.get(id);
     if (conn && conn->valid()) conn->shutdown();
   }
 #ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
@@ -309,6 +552,22 @@ const plain::net::packet::dispatch_func &Manager::dispatcher() const noexcept {
   return impl_->dispatcher;
 }
 
+void Manager::set_handler(
+  packet::id_t id, packet::handler_func func) noexcept {
+  auto &handlers = impl_->handlers;
+  if (id >= handlers.size()) {
+    if (!func) return;
+    handlers.resize(static_cast<size_t>(id) + 1);
+  }
+  handlers[id] = func;
+}
+
+plain::net::packet::handler_func
+Manager::handler(packet::id_t id) const noexcept {
+  const auto &handlers = impl_->handlers;
+  return id < handlers.size() ? handlers[id] : nullptr;
+}
+
 void Manager::set_connect_callback(callable_func func) noexcept {
   impl_->connect_callback = func;
 }
@@ -321,46 +580,94 @@ Manager::connect_callback() const noexcept {
 void Manager::set_disconnect_callback(callable_func func) noexcept {
   impl_->disconnect_callback = func;
 }
+
+void Manager::set_high_watermark_callback(callable_func func) noexcept {
+  impl_->high_watermark_callback = func;
+}
+
+void Manager::set_low_watermark_callback(callable_func func) noexcept {
+  impl_->low_watermark_callback = func;
+}
+
+void Manager::on_watermark(Basic *conn, bool high) noexcept {
+  const auto &func =
+    high ? impl_->high_watermark_callback : impl_->low_watermark_callback;
+  if (static_cast<bool>(func)) func(conn);
+}
+
+int64_t Manager::idle_clock() const noexcept {
+  return impl_->idle_clock.load(std::memory_order_relaxed);
+}
+
+// The active time is coarse(the clock of the last check), so the timeout
+// add one interval that the connection never removed early.
+void Manager::check_idle() noexcept {
+  if (!running()) return;
+  auto now = Impl::now();
+  impl_->idle_clock.store(now, std::memory_order_relaxed);
+  const auto interval = impl_->idle_check_interval;
+  const int64_t read_timeout{setting_.read_idle_timeout};
+  const int64_t write_timeout{setting_.write_idle_timeout};
+  // The heartbeat only with the default codec(the custom one may encode the
+  // empty packet as the peer data).
+  const int64_t heartbeat_interval{
+    impl_->codec.encode_to || impl_->codec.encode ?
+    0 : setting_.heartbeat_interval};
+  const auto &info = impl_->connection_info;
+  auto max_id = info.base + info.max_id.load(std::memory_order_acquire);
+  for (id_t id = info.base + 1; id <= max_id; ++id) {
+    auto &slot = info.slots[info.index(id)];
+    auto generation = slot.generation.load(std::memory_order_acquire);
+    if (!(generation & 0x1)) continue;
+    auto conn = slot.raw.load(std::memory_order_acquire);
+    if (!conn) continue;
+    auto input_idle = now - conn->active_time(true);
+    auto output_idle = now - conn->active_time(false);
+    if ((read_timeout > 0 && input_idle >= read_timeout + interval) ||
+        (write_timeout > 0 && output_idle >= write_timeout + interval)) {
+      // The slot may reused by a new connection(the generation changed).
+      LOG_WARN << setting_.name << " remove idle connection: " << id;
+      Impl::remove(this, id, false, true, generation);
+      continue;
+    }
+    if (heartbeat_interval > 0 && output_idle >= heartbeat_interval &&
+        !conn->custom_codec() && conn->output_size() == 0 &&
+        conn->send_queue_size() == 0) {
+      conn->send(impl_->heartbeat);
+    }
+  }
+}
   
 std::shared_ptr<plain::net::connection::Basic>
 Manager::get_conn(id_t id) const noexcept {
-  std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
-  auto index = static_cast<size_t>(id) - 1;
-  if (index >= impl_->connection_info.list.size())
-    return {};
-  auto r = impl_->connection_info.list[index];
-  // if (!r || !r->valid()) return {};
-  return r;
+  return impl_->connection_info.get(id);
 }
 
 std::shared_ptr<plain::net::connection::Basic> Manager::new_conn() noexcept {
-  std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
-  if (is_full()) {
-    return {};
+  auto &info = impl_->connection_info;
+  id_t id{info.pop_free()};
+  if (id == kInvalidId) {
+    auto max_id = info.max_id.load(std::memory_order_relaxed);
+    do {
+      if (static_cast<size_t>(max_id) >= info.capacity) return {};
+    } while (!info.max_id.compare_exchange_weak(
+      max_id, max_id + 1, std::memory_order_acq_rel));
+    id = info.base + max_id + 1;
   }
-  id_t id{kInvalidId};
-  if (!impl_->connection_info.free_ids.empty()) {
-    auto it = impl_->connection_info.free_ids.begin();
-    id = *it;
-    impl_->connection_info.free_ids.erase(it);
-  } else {
-    id = ++(impl_->connection_info.max_id);
-    if (static_cast<size_t>(id) > impl_->connection_info.list.size()) {
-      impl_->connection_info.list.emplace_back(std::make_shared<Basic>());
-    }
+  std::shared_ptr<Basic> r;
+  try {
+    r = info.get_or_create(id);
+  } catch (...) {
+    info.push_free(id);
+    return {};
   }
-  if (id == kInvalidId) return {};
-  auto r = impl_->connection_info.list[id - 1];
-  if (!r) r = std::make_shared<Basic>();
   r->set_id(id);
   r->init();
   r->set_manager(shared_from_this());
-  ++(impl_->connection_info.size);
-  if (impl_->connection_info.ids.use_count() > 1) {
-    impl_->connection_info.ids.reset(
-      new std::set<connection::id_t>(*impl_->connection_info.ids));
-  }
-  impl_->connection_info.ids->emplace(id);
+  r->set_active_time(true, idle_clock());
+  r->set_active_time(false, idle_clock());
+  info.slots[info.index(id)].generation.fetch_add(1, std::memory_order_acq_rel);
+  info.size.fetch_add(1, std::memory_order_relaxed);
 
 #ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
   impl_->cv.notify_one(); // Just one for wait work.
@@ -369,9 +676,10 @@ std::shared_ptr<plain::net::connection::Basic> Manager::new_conn() noexcept {
 }
   
 bool Manager::is_full() const noexcept {
-  return impl_->connection_info.free_ids.empty() &&
-    impl_->connection_info.max_id != kInvalidId &&
-    impl_->connection_info.max_id >= static_cast<id_t>(setting_.max_count);
+  const auto &info = impl_->connection_info;
+  return (info.free_head.load(std::memory_order_relaxed) & 0xffffffff) == 0 &&
+    static_cast<size_t>(info.max_id.load(std::memory_order_relaxed)) >=
+    info.capacity;
 }
 
 void Manager::remove(
@@ -382,62 +690,89 @@ void Manager::remove(
   
 void Manager::remove(
   connection::id_t conn_id, bool no_event, bool sock) noexcept {
-  std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
+  Impl::remove(this, conn_id, no_event, sock, std::nullopt);
+}
+
+void Manager::Impl::remove(
+  Manager *manager, connection::id_t conn_id, bool no_event, bool sock,
+  std::optional<uint32_t> expected) noexcept {
+  auto &impl = manager->impl_;
+  std::unique_lock<decltype(impl->mutex)> auto_lock(impl->mutex);
   assert(conn_id != connection::kInvalidId);
-  if (conn_id <= 0 || conn_id > impl_->connection_info.max_id)
-    return;
-  auto &conn = impl_->connection_info.list[conn_id - 1];
+  auto &info = impl->connection_info;
+  if (conn_id <= info.base || conn_id > info.base + info.max_id) return;
+  auto &slot = info.slots[info.index(conn_id)];
+  auto generation = slot.generation.load(std::memory_order_acquire);
+  if (!(generation & 0x1)) return; // Removed.
+  // Only the remove free the slot(in the lock), so it not reused after.
+  if (expected && *expected != generation) return;
+  auto conn = info.get(conn_id);
   if (conn) {
     if (!no_event) {
       conn->on_disconnect();
-      if (static_cast<bool>(impl_->disconnect_callback))
-        impl_->disconnect_callback(conn.get());
+      if (static_cast<bool>(impl->disconnect_callback))
+        impl->disconnect_callback(conn.get());
     }
-    if (sock && conn->socket()->valid()) this->sock_remove(conn->socket()->id());
+    if (sock && conn->socket()->valid())
+      manager->sock_remove(conn->socket()->id());
     conn->shutdown();
     conn->close();
     if (conn->is_keep_alive()) return; // The connector will keep alive.
   }
-  impl_->connection_info.free_ids.emplace(conn_id);
-  if (impl_->connection_info.size > 0)
-    --(impl_->connection_info.size);
-  if (impl_->connection_info.ids.use_count() > 1) {
-    impl_->connection_info.ids.reset(
-      new std::set<connection::id_t>(*impl_->connection_info.ids));
-  }
-  impl_->connection_info.ids->erase(conn_id);
+  if (!slot.generation.compare_exchange_strong(
+    generation, generation + 1, std::memory_order_acq_rel)) return;
+  info.size.fetch_sub(1, std::memory_order_relaxed);
+  info.push_free(conn_id);
 }
   
 void Manager::broadcast(std::shared_ptr<packet::Basic> packet) noexcept {
   assert(packet);
-  decltype(impl_->connection_info.ids) ids;
-  {
-    std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
-    ids = impl_->connection_info.ids;
+  auto bytes = impl_->encode(packet);
+  if (!bytes) {
+    LOG_ERROR << setting_.name << " broadcast encode failed: " << packet->id();
+    return;
   }
-  if (ids.use_count() == 0) return;
-  for (auto id : *ids) {
-    auto conn = get_conn(id);
-    if (conn && conn->valid()) conn->send(packet);
+  // The in use slots only(the closed skipped by the work), no socket check
+  // and shared pointer copy for each.
+  const auto &info = impl_->connection_info;
+  auto max_id = info.base + info.max_id.load(std::memory_order_acquire);
+  for (id_t id = info.base + 1; id <= max_id; ++id) {
+    if (!info.in_use(id)) continue;
+    auto conn = info.slots[info.index(id)].raw.load(std::memory_order_acquire);
+    if (conn) conn->send_encoded(packet, bytes);
   }
 }
 
-void Manager::foreach(std::function<void(std::shared_ptr<Basic> conn)> func) {
-  decltype(impl_->connection_info.ids) ids;
-  {
-    std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
-    ids = impl_->connection_info.ids;
+void Manager::broadcast(
+  std::shared_ptr<packet::Basic> packet, std::span<const id_t> ids) noexcept {
+  assert(packet);
+  const auto &info = impl_->connection_info;
+  std::shared_ptr<const bytes_t> bytes;
+  for (auto id : ids) {
+    if (!info.in_use(id)) continue; // The other reactor ids out of range.
+    auto conn = info.slots[info.index(id)].raw.load(std::memory_order_acquire);
+    if (!conn) continue;
+    if (!bytes && !(bytes = impl_->encode(packet))) {
+      LOG_ERROR << setting_.name << " broadcast encode failed: "
+        << packet->id();
+      return;
+    }
+    conn->send_encoded(packet, bytes);
   }
-  if (ids.use_count() == 0) return;
-  for (auto id : *ids) {
-    auto conn = get_conn(id);
+}
+
+void Manager::foreach(std::function<void(std::shared_ptr<Basic> conn)> func) {
+  const auto &info = impl_->connection_info;
+  auto max_id = info.base + info.max_id.load(std::memory_order_acquire);
+  for (id_t id = info.base + 1; id <= max_id; ++id) {
+    if (!info.in_use(id)) continue;
+    auto conn = info.get(id);
     if (conn && conn->valid()) func(conn);
   }
 }
 
 size_t Manager::size() const noexcept {
-  std::unique_lock<decltype(impl_->mutex)> auto_lock(impl_->mutex);
-  return impl_->connection_info.ids->size();
+  return impl_->connection_info.size.load(std::memory_order_relaxed);
 }
 
 std::shared_ptr<plain::net::connection::Basic> Manager::accept() noexcept {
@@ -487,21 +822,19 @@ std::shared_ptr<plain::net::connection::Basic> Manager::accept() noexcept {
   if (static_cast<bool>(impl_->connect_callback)) {
     impl_->connect_callback(conn.get());
   }
+  if (setting_.rpc_method_ids) impl_->send_rpc_methods(conn.get());
   return conn;
 }
   
 std::shared_ptr<plain::net::connection::Basic>
 Manager::accept(socket::id_t sock_id) noexcept {
+  if (sock_id == socket::kInvalidId) return {};
   auto conn = new_conn();
-  std::cout << "accept: " << setting_.name << "|" << sock_id << std::endl;
   if (!conn) {
     LOG_WARN << setting_.name << " new conn failed";
-    auto sock = std::make_shared<socket::Basic>();
-    listen_sock_->accept(sock);
-    sock->close();
+    socket::close(sock_id); // Accepted already.
     return {};
   }
-  if (sock_id == socket::kInvalidId) return {};
   conn->socket()->set_id(sock_id);
   if (!conn->socket()->set_nonblocking()) {
     remove(conn, true);
@@ -530,6 +863,7 @@ Manager::accept(socket::id_t sock_id) noexcept {
   if (static_cast<bool>(impl_->connect_callback)) {
     impl_->connect_callback(conn.get());
   }
+  if (setting_.rpc_method_ids) impl_->send_rpc_methods(conn.get());
   return conn;
 }
 
@@ -566,25 +900,117 @@ void Manager::execute(std::function<void()> func) {
 }
 
 void Manager::increase_send_size(size_t size) {
-  std::unique_lock<decltype(impl_->mutex)> lock{impl_->mutex};
-  impl_->send_size += static_cast<uint64_t>(size);
+  impl_->counter().send_size.fetch_add(size, std::memory_order_relaxed);
 }
   
 void Manager::increase_recv_size(size_t size) {
-  std::unique_lock<decltype(impl_->mutex)> lock{impl_->mutex};
-  impl_->recv_size += static_cast<uint64_t>(size);
+  impl_->counter().recv_size.fetch_add(size, std::memory_order_relaxed);
+}
+
+void Manager::increase_recv_packet(size_t copy_size) noexcept {
+  auto &counter = impl_->counter();
+  counter.recv_packet_count.fetch_add(1, std::memory_order_relaxed);
+  if (copy_size > 0)
+    counter.recv_copy_size.fetch_add(copy_size, std::memory_order_relaxed);
+}
+
+void Manager::increase_send_packet(size_t count) noexcept {
+  impl_->counter().send_packet_count.fetch_add(
+    count, std::memory_order_relaxed);
+}
+
+void Manager::increase_decode_error() noexcept {
+  impl_->counter().decode_error_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Manager::increase_send_zero_copy(size_t size) noexcept {
+  impl_->counter().send_zero_copy_size.fetch_add(
+    size, std::memory_order_relaxed);
 }
 
 uint64_t Manager::send_size() const noexcept {
-  return impl_->send_size;
+  return impl_->sum(&detail::TrafficCounter::send_size);
 }
 
 uint64_t Manager::recv_size() const noexcept {
-  return impl_->recv_size;
+  return impl_->sum(&detail::TrafficCounter::recv_size);
+}
+
+uint64_t Manager::recv_packet_count() const noexcept {
+  return impl_->sum(&detail::TrafficCounter::recv_packet_count);
+}
+
+uint64_t Manager::recv_copy_size() const noexcept {
+  return impl_->sum(&detail::TrafficCounter::recv_copy_size);
+}
+
+plain::net::connection::stats_t Manager::stats() const noexcept {
+  using detail::TrafficCounter;
+  stats_t r;
+  r.send_size = impl_->sum(&TrafficCounter::send_size);
+  r.recv_size = impl_->sum(&TrafficCounter::recv_size);
+  r.send_packet_count = impl_->sum(&TrafficCounter::send_packet_count);
+  r.recv_packet_count = impl_->sum(&TrafficCounter::recv_packet_count);
+  r.recv_copy_size = impl_->sum(&TrafficCounter::recv_copy_size);
+  r.decode_error_count = impl_->sum(&TrafficCounter::decode_error_count);
+  r.send_zero_copy_size = impl_->sum(&TrafficCounter::send_zero_copy_size);
+  r.conn_count = size();
+  {
+    std::unique_lock<decltype(impl_->mutex)> lock{impl_->mutex};
+    r.work_queue_size = impl_->wait_work_conn_id_deque.size();
+  }
+  const auto &info = impl_->connection_info;
+  auto max_id = info.base + info.max_id.load(std::memory_order_acquire);
+  for (id_t id = info.base + 1; id <= max_id; ++id) {
+    if (!info.in_use(id)) continue;
+    auto conn = info.get(id);
+    if (!conn) continue;
+    auto input_size = conn->input_size();
+    auto output_size = conn->output_size();
+    r.send_queue_size += conn->send_queue_size();
+    r.input_size += input_size;
+    r.output_size += output_size;
+    r.conn_input_size_max = std::max(r.conn_input_size_max, input_size);
+    r.conn_output_size_max = std::max(r.conn_output_size_max, output_size);
+  }
+  return r;
+}
+
+std::vector<plain::net::connection::conn_stats_t>
+Manager::conn_stats() const {
+  std::vector<conn_stats_t> r;
+  const auto &info = impl_->connection_info;
+  auto max_id = info.base + info.max_id.load(std::memory_order_acquire);
+  for (id_t id = info.base + 1; id <= max_id; ++id) {
+    if (!info.in_use(id)) continue;
+    auto conn = info.get(id);
+    if (!conn) continue;
+    r.emplace_back(conn_stats_t{
+      id, conn->input_size(), conn->output_size(), conn->send_queue_size()});
+  }
+  return r;
+}
+
+std::shared_ptr<plain::net::packet::Pool>
+Manager::packet_pool() const noexcept {
+  return impl_->packet_pool;
 }
 
 // For banlance connection works.
 void Manager::enqueue(connection::id_t id) noexcept {
+#ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
+  if (impl_->reactor) {
+    if (id == connection::kInvalidId || !running()) return;
+    if (in_worker()) {
+      impl_->reactor_ids.push_back(id);
+    } else {
+      impl_->reactor_remote_ids.push(id);
+      if (!impl_->reactor_wakeup.exchange(true, std::memory_order_seq_cst))
+        send_ctrl_cmd("w");
+    }
+    return;
+  }
+#endif
   std::unique_lock<decltype(impl_->mutex)> lock{impl_->mutex};
   if (!running()) return;
   auto working_conn_count =
@@ -625,6 +1051,26 @@ std::string Manager::get_name(connection::id_t conn_id) const noexcept {
   return it->second;
 }
 
+void Manager::set_reactor([[maybe_unused]] bool on) noexcept {
+  assert(!running());
+#ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
+  impl_->reactor = on;
+#endif
+}
+
+bool Manager::in_worker() const noexcept {
+#ifndef PLAIN_NET_MANAGER_ENABLE_COROUTINE
+  return std::this_thread::get_id() == impl_->worker_id;
+#else
+  return false;
+#endif
+}
+
+void Manager::set_id_base(id_t base) noexcept {
+  assert(!running());
+  impl_->connection_info.base = base;
+}
+
 plain::net::rpc::Dispatcher *Manager::rpc_dispatcher() const noexcept {
   return impl_->rpc_dispatcher.get();
 }
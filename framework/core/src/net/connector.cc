@@ -63,6 +63,11 @@ const plain::net::stream::codec_t &Connector::codec() const noexcept {
 void Connector::set_dispatcher(packet::dispatch_func func) noexcept {
   impl_->manager->set_dispatcher(func);
 }
+
+void Connector::set_handler(
+  packet::id_t id, packet::handler_func func) noexcept {
+  impl_->manager->set_handler(id, func);
+}
   
 const plain::net::packet::dispatch_func &Connector::dispatcher() const noexcept {
   return impl_->manager->dispatcher();
@@ -76,6 +81,16 @@ void Connector::set_disconnect_callback(
   connection::callable_func func) noexcept {
   impl_->manager->set_disconnect_callback(func);
 }
+
+void Connector::set_high_watermark_callback(
+  connection::callable_func func) noexcept {
+  impl_->manager->set_high_watermark_callback(func);
+}
+
+void Connector::set_low_watermark_callback(
+  connection::callable_func func) noexcept {
+  impl_->manager->set_low_watermark_callback(func);
+}
  
 std::shared_ptr<plain::net::connection::Basic>
 Connector::get_conn(connection::id_t id) const noexcept {
@@ -89,6 +104,12 @@ bool Connector::is_full() const noexcept {
 void Connector::broadcast(std::shared_ptr<packet::Basic> packet) noexcept {
   return impl_->manager->broadcast(packet);
 }
+
+void Connector::broadcast(
+  std::shared_ptr<packet::Basic> packet,
+  std::span<const connection::id_t> ids) noexcept {
+  return impl_->manager->broadcast(packet, ids);
+}
   
 std::shared_ptr<plain::concurrency::executor::Basic>
 Connector::get_executor() const noexcept {
@@ -213,6 +234,28 @@ uint64_t Connector::send_size() const noexcept {
 uint64_t Connector::recv_size() const noexcept {
   return impl_->manager->recv_size();
 }
+
+uint64_t Connector::recv_packet_count() const noexcept {
+  return impl_->manager->recv_packet_count();
+}
+
+uint64_t Connector::recv_copy_size() const noexcept {
+  return impl_->manager->recv_copy_size();
+}
+
+plain::net::connection::stats_t Connector::stats() const noexcept {
+  return impl_->manager->stats();
+}
+
+std::vector<plain::net::connection::conn_stats_t>
+Connector::conn_stats() const {
+  return impl_->manager->conn_stats();
+}
+
+std::shared_ptr<plain::net::packet::Pool>
+Connector::packet_pool() const noexcept {
+  return impl_->manager->packet_pool();
+}
   
 bool Connector::running() const noexcept {
   return impl_->manager->running();
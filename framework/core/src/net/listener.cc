@@ -7,7 +7,13 @@
 using plain::net::Listener;
 
 struct Listener::Impl {
-  std::shared_ptr<connection::Manager> manager;
+  std::shared_ptr<connection::Manager> manager; // The first reactor.
+  std::vector<std::shared_ptr<connection::Manager>> reactors;
+  uint32_t reactor_max_count{0}; // The connection count max of one reactor.
+  template <typename F>
+  void foreach(F &&func) const {
+    for (const auto &reactor : reactors) func(reactor);
+  }
 };
   
 Listener::Listener(
@@ -15,35 +21,67 @@ Listener::Listener(
   std::shared_ptr<concurrency::executor::Basic> executor) :
   rpc_dispatcher_{std::make_shared<rpc::Dispatcher>()},
   impl_{std::make_unique<Impl>()} {
-  impl_->manager = make_manager(setting, executor);
-  impl_->manager->set_rpc_dispatcher(rpc_dispatcher_);
-  assert(impl_->manager);
+  auto reactor_count = std::max<uint32_t>(setting.reactor_count, 1);
+  auto reactor_setting = setting;
+  reactor_setting.reactor_count = reactor_count;
+  reactor_setting.max_count =
+    (setting.max_count + reactor_count - 1) / reactor_count;
+  reactor_setting.default_count = std::min(
+    reactor_setting.max_count,
+    (setting.default_count + reactor_count - 1) / reactor_count);
+  impl_->reactor_max_count = reactor_setting.max_count;
+  for (uint32_t i = 0; i < reactor_count; ++i) {
+    if (i > 0 && !setting.name.empty())
+      reactor_setting.name = setting.name + "." + std::to_string(i);
+    if (reactor_count > 1 && !setting.cpus.empty())
+      reactor_setting.cpus = {setting.cpus[i % setting.cpus.size()]};
+    auto manager = make_manager(reactor_setting, executor);
+    assert(manager);
+    manager->set_id_base(
+      static_cast<connection::id_t>(i * reactor_setting.max_count));
+    manager->set_rpc_dispatcher(rpc_dispatcher_);
+    impl_->reactors.emplace_back(manager);
+  }
+  impl_->manager = impl_->reactors.front();
 }
 
 Listener::~Listener() {
-  if (impl_->manager->running()) impl_->manager->stop();
+  stop();
 }
   
 bool Listener::start() {
   if (impl_->manager->running()) return true;
-  impl_->manager->listen_sock_ = std::make_shared<socket::Listener>();
-  Address addr{impl_->manager->setting_.address};
-  if (!impl_->manager->listen_sock_->init(
-      addr, impl_->manager->setting_.socket_type))
-    return false;
-  if (impl_->manager->setting_.address.empty())
-    impl_->manager->setting_.address = address().text();
-  impl_->manager->listen_fd_ = impl_->manager->listen_sock_->id();
-  return impl_->manager->start();
+  auto reuse_port = impl_->reactors.size() > 1;
+  for (auto &manager : impl_->reactors) {
+    // The others listen the first address(the port maybe auto assigned).
+    manager->setting_.address = impl_->manager->setting_.address;
+    manager->listen_sock_ = std::make_shared<socket::Listener>();
+    Address addr{manager->setting_.address};
+    if (!manager->listen_sock_->init(
+        addr, manager->setting_.socket_type, 5, reuse_port)) {
+      stop();
+      return false;
+    }
+    if (manager->setting_.address.empty())
+      manager->setting_.address = manager->listen_sock_->address().text();
+    manager->listen_fd_ = manager->listen_sock_->id();
+    if (!manager->start()) {
+      stop();
+      return false;
+    }
+  }
+  return true;
 }
   
 void Listener::stop() {
   // Manager must stoped.
-  if (impl_->manager->running()) impl_->manager->stop();
+  impl_->foreach([](const auto &manager) {
+    if (manager->running()) manager->stop();
+  });
 }
 
 void Listener::set_codec(const stream::codec_t &codec) noexcept {
-  impl_->manager->set_codec(codec);
+  impl_->foreach([&codec](const auto &manager) { manager->set_codec(codec); });
 }
   
 const plain::net::stream::codec_t &Listener::codec() const noexcept {
@@ -51,7 +89,16 @@ const plain::net::stream::codec_t &Listener::codec() const noexcept {
 }
   
 void Listener::set_dispatcher(packet::dispatch_func func) noexcept {
-  impl_->manager->set_dispatcher(func);
+  impl_->foreach([&func](const auto &manager) {
+    manager->set_dispatcher(func);
+  });
+}
+
+void Listener::set_handler(
+  packet::id_t id, packet::handler_func func) noexcept {
+  impl_->foreach([id, func](const auto &manager) {
+    manager->set_handler(id, func);
+  });
 }
   
 const plain::net::packet::dispatch_func &Listener::dispatcher() const noexcept {
@@ -59,25 +106,67 @@ const plain::net::packet::dispatch_func &Listener::dispatcher() const noexcept {
 }
   
 void Listener::set_connect_callback(connection::callable_func func) noexcept {
-  impl_->manager->set_connect_callback(func);
+  impl_->foreach([&func](const auto &manager) {
+    manager->set_connect_callback(func);
+  });
 }
   
 void Listener::set_disconnect_callback(
   connection::callable_func func) noexcept {
-  impl_->manager->set_disconnect_callback(func);
+  impl_->foreach([&func](const auto &manager) {
+    manager->set_disconnect_callback(func);
+  });
+}
+
+void Listener::set_high_watermark_callback(
+  connection::callable_func func) noexcept {
+  impl_->foreach([&func](const auto &manager) {
+    manager->set_high_watermark_callback(func);
+  });
+}
+
+void Listener::set_low_watermark_callback(
+  connection::callable_func func) noexcept {
+  impl_->foreach([&func](const auto &manager) {
+    manager->set_low_watermark_callback(func);
+  });
 }
 
 std::shared_ptr<plain::net::connection::Basic>
 Listener::get_conn(connection::id_t id) const noexcept {
-  return impl_->manager->get_conn(id);
+  if (id <= 0) return {};
+  auto index = static_cast<size_t>(id - 1) / impl_->reactor_max_count;
+  if (index >= impl_->reactors.size()) return {};
+  return impl_->reactors[index]->get_conn(id);
 }
   
+size_t Listener::size() const noexcept {
+  size_t r{0};
+  impl_->foreach([&r](const auto &manager) { r += manager->size(); });
+  return r;
+}
+
 bool Listener::is_full() const noexcept {
-  return impl_->manager->is_full();
+  bool r{true};
+  impl_->foreach([&r](const auto &manager) {
+    if (!manager->is_full()) r = false;
+  });
+  return r;
 }
   
 void Listener::broadcast(std::shared_ptr<packet::Basic> packet) noexcept {
-  return impl_->manager->broadcast(packet);
+  impl_->foreach([&packet](const auto &manager) {
+    manager->broadcast(packet);
+  });
+}
+
+// The reactors skip the ids not belong to them.
+void Listener::broadcast(
+  std::shared_ptr<packet::Basic> packet,
+  std::span<const connection::id_t> ids) noexcept {
+  impl_->foreach([&packet, ids](const auto &manager) {
+    manager->broadcast(packet, ids);
+  });
 }
   
 std::shared_ptr<plain::concurrency::executor::Basic>
@@ -91,11 +180,70 @@ plain::net::Address Listener::address() const noexcept {
 }
 
 uint64_t Listener::send_size() const noexcept {
-  return impl_->manager->send_size();
+  uint64_t r{0};
+  impl_->foreach([&r](const auto &manager) { r += manager->send_size(); });
+  return r;
 }
 
 uint64_t Listener::recv_size() const noexcept {
-  return impl_->manager->recv_size();
+  uint64_t r{0};
+  impl_->foreach([&r](const auto &manager) { r += manager->recv_size(); });
+  return r;
+}
+
+uint64_t Listener::recv_packet_count() const noexcept {
+  uint64_t r{0};
+  impl_->foreach([&r](const auto &manager) {
+    r += manager->recv_packet_count();
+  });
+  return r;
+}
+
+uint64_t Listener::recv_copy_size() const noexcept {
+  uint64_t r{0};
+  impl_->foreach([&r](const auto &manager) {
+    r += manager->recv_copy_size();
+  });
+  return r;
+}
+
+plain::net::connection::stats_t Listener::stats() const noexcept {
+  connection::stats_t r;
+  impl_->foreach([&r](const auto &manager) {
+    auto stats = manager->stats();
+    r.send_size += stats.send_size;
+    r.recv_size += stats.recv_size;
+    r.send_packet_count += stats.send_packet_count;
+    r.recv_packet_count += stats.recv_packet_count;
+    r.recv_copy_size += stats.recv_copy_size;
+    r.decode_error_count += stats.decode_error_count;
+    r.send_zero_copy_size += stats.send_zero_copy_size;
+    r.conn_count += stats.conn_count;
+    r.work_queue_size += stats.work_queue_size;
+    r.send_queue_size += stats.send_queue_size;
+    r.input_size += stats.input_size;
+    r.output_size += stats.output_size;
+    r.conn_input_size_max =
+      std::max(r.conn_input_size_max, stats.conn_input_size_max);
+    r.conn_output_size_max =
+      std::max(r.conn_output_size_max, stats.conn_output_size_max);
+  });
+  return r;
+}
+
+std::vector<plain::net::connection::conn_stats_t>
+Listener::conn_stats() const {
+  std::vector<connection::conn_stats_t> r;
+  impl_->foreach([&r](const auto &manager) {
+    auto conn_stats = manager->conn_stats();
+    r.insert(r.end(), conn_stats.begin(), conn_stats.end());
+  });
+  return r;
+}
+
+std::shared_ptr<plain::net::packet::Pool>
+Listener::packet_pool() const noexcept {
+  return impl_->manager->packet_pool();
 }
 
 bool Listener::running() const noexcept {
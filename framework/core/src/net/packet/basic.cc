@@ -11,14 +11,34 @@ enum {
 };
 
 struct Basic::Impl {
-  id_t id;
+  id_t id{0};
   bytes_t data;
   size_t offset{0};
   uint8_t flag{0};
+  size_t copied{0};
+  std::shared_ptr<const bytes_t> owner; // The borrowed data owner.
+  const_byte_span_t borrowed;
   bool have_flag(uint32_t flag) const noexcept;
   void set_flag(bool flag, uint32_t type) noexcept;
+  const_byte_span_t view() const noexcept;
+  void append(const std::byte *value, size_t length);
 };
 
+plain::const_byte_span_t Basic::Impl::view() const noexcept {
+  return owner ? borrowed : as_const_bytes(data);
+}
+
+void Basic::Impl::append(const std::byte *value, size_t length) {
+  if (owner) { // Copy on write.
+    data.assign(borrowed.data(), borrowed.size());
+    copied += borrowed.size();
+    owner.reset();
+    borrowed = {};
+  }
+  data.append(value, length);
+  copied += length;
+}
+
 bool Basic::Impl::have_flag(uint32_t type) const noexcept {
   return flag & (1 << type);
 }
@@ -36,26 +56,26 @@ size_t Basic::write(std::string_view str) {
   const auto *buffer = reinterpret_cast<const std::byte *>(str.data());
   auto size = str.size();
   *this << static_cast<uint32_t>(size);
-  impl_->data.append(buffer, size);
+  impl_->append(buffer, size);
   return size;
 }
 
 size_t Basic::write(const bytes_t &bytes) {
   if (!impl_->have_flag(kWriteableFlag)) return 0;
   *this << static_cast<uint32_t>(bytes.size());
-  impl_->data.append(bytes);
+  impl_->append(bytes.data(), bytes.size());
   return bytes.size();
 }
 
 size_t Basic::write(const std::byte *bytes, size_t length) {
   if (!impl_->have_flag(kWriteableFlag)) return 0;
-  impl_->data.append(bytes, length);
+  impl_->append(bytes, length);
   return length;
 }
 
 size_t Basic::write(const_byte_span_t bytes) {
   if (!impl_->have_flag(kWriteableFlag)) return 0;
-  impl_->data.append(bytes.data(), bytes.size());
+  impl_->append(bytes.data(), bytes.size());
   return bytes.size();
 }
 
@@ -64,10 +84,11 @@ size_t Basic::read(std::string &str) {
   uint32_t length{0};
   *this >> length;
   if (length == 0) return 0;
-  auto left = impl_->data.size() - impl_->offset;
+  auto data = impl_->view();
+  auto left = data.size() - impl_->offset;
   if (left < length) return 0;
   const auto *buffer = reinterpret_cast<const char *>(
-    impl_->data.data() + impl_->offset);
+    data.data() + impl_->offset);
   str.append(buffer, length);
   impl_->offset += length;
   return str.size();
@@ -78,9 +99,10 @@ size_t Basic::read(bytes_t &bytes) {
   uint32_t length{0};
   *this >> length;
   if (length == 0) return 0;
-  auto left = impl_->data.size() - impl_->offset;
+  auto data = impl_->view();
+  auto left = data.size() - impl_->offset;
   if (left < length) return 0;
-  const auto *buffer = impl_->data.data() + impl_->offset;
+  const auto *buffer = data.data() + impl_->offset;
   bytes.insert(0, buffer, length);
   impl_->offset += length;
   return bytes.size();
@@ -88,16 +110,17 @@ size_t Basic::read(bytes_t &bytes) {
 
 size_t Basic::read(std::byte *value, size_t length) {
   if (!value || !impl_->have_flag(kReadableFlag)) return 0;
-  auto left = impl_->data.size() - impl_->offset;
+  auto data = impl_->view();
+  auto left = data.size() - impl_->offset;
   if (left < length) return 0;
-  const auto *buffer = impl_->data.data() + impl_->offset;
+  const auto *buffer = data.data() + impl_->offset;
   std::memcpy(value, buffer, length);
   impl_->offset += length;
   return length;
 }
 
 size_t Basic::remove(size_t length) noexcept {
-  auto left = impl_->data.size() - impl_->offset;
+  auto left = impl_->view().size() - impl_->offset;
   if (left < length) {
     impl_->offset += left;
     return left;
@@ -107,13 +130,41 @@ size_t Basic::remove(size_t length) noexcept {
 }
   
 plain::const_byte_span_t Basic::data() const noexcept {
-  return as_const_bytes(impl_->data);
+  return impl_->view();
 }
   
 size_t Basic::offset() const noexcept {
   return impl_->offset;
 }
 
+void Basic::set_data(
+  std::shared_ptr<const bytes_t> owner, const_byte_span_t data,
+  size_t copied) noexcept {
+  impl_->copied += copied;
+  impl_->data.clear();
+  impl_->offset = 0;
+  impl_->borrowed = owner ? data : const_byte_span_t{};
+  impl_->owner = std::move(owner);
+}
+
+size_t Basic::copied() const noexcept {
+  return impl_->copied;
+}
+
+void Basic::clear() noexcept {
+  impl_->id = 0;
+  impl_->data.clear();
+  impl_->offset = 0;
+  impl_->flag = 0;
+  impl_->copied = 0;
+  impl_->owner.reset();
+  impl_->borrowed = {};
+}
+
+size_t Basic::capacity() const noexcept {
+  return impl_->data.capacity();
+}
+
 void Basic::set_readable(bool flag) noexcept {
   impl_->set_flag(flag, kReadableFlag);
 }
@@ -0,0 +1,134 @@
+#include "plain/net/packet/pool.h"
+#include "plain/net/packet/basic.h"
+
+using plain::net::packet::Pool;
+using plain::net::packet::Basic;
+
+struct Pool::Impl {
+  Impl(size_t _max_size, size_t _max_capacity) :
+    max_size{_max_size}, max_capacity{_max_capacity} {}
+  ~Impl();
+  // The shared pointer control block memory.
+  static constexpr size_t kBlockSize{64};
+  std::mutex mutex;
+  std::vector<Basic *> packets;
+  std::vector<void *> blocks;
+  size_t max_size;
+  size_t max_capacity;
+  std::atomic_uint64_t hits{0};
+  std::atomic_uint64_t misses{0};
+  void recycle(Basic *packet) noexcept;
+  void *allocate_block();
+  void deallocate_block(void *block) noexcept;
+
+  struct Recycler {
+    std::shared_ptr<Impl> pool;
+    void operator()(Basic *packet) const noexcept {
+      pool->recycle(packet);
+    }
+  };
+
+  template <typename T>
+  struct Allocator {
+    using value_type = T;
+    std::shared_ptr<Impl> pool;
+    Allocator(std::shared_ptr<Impl> _pool) noexcept : pool{std::move(_pool)} {}
+    template <typename U>
+    Allocator(const Allocator<U> &other) noexcept : pool{other.pool} {}
+    static constexpr bool pooled(size_t n) noexcept {
+      return n == 1 && sizeof(T) <= kBlockSize &&
+        alignof(T) <= alignof(std::max_align_t);
+    }
+    T *allocate(size_t n) {
+      if (pooled(n)) return static_cast<T *>(pool->allocate_block());
+      return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T *p, size_t n) noexcept {
+      if (pooled(n)) return pool->deallocate_block(p);
+      std::allocator<T>{}.deallocate(p, n);
+    }
+    template <typename U>
+    bool operator==(const Allocator<U> &other) const noexcept {
+      return pool == other.pool;
+    }
+  };
+};
+
+Pool::Impl::~Impl() {
+  for (auto packet : packets) delete packet;
+  for (auto block : blocks) ::operator delete(block);
+}
+
+void Pool::Impl::recycle(Basic *packet) noexcept {
+  if (packet->capacity() <= max_capacity) {
+    packet->clear();
+    std::unique_lock<std::mutex> lock{mutex};
+    if (packets.size() < max_size) {
+      packets.emplace_back(packet);
+      return;
+    }
+  }
+  delete packet;
+}
+
+void *Pool::Impl::allocate_block() {
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    if (!blocks.empty()) {
+      auto r = blocks.back();
+      blocks.pop_back();
+      return r;
+    }
+  }
+  return ::operator new(kBlockSize);
+}
+
+void Pool::Impl::deallocate_block(void *block) noexcept {
+  {
+    std::unique_lock<std::mutex> lock{mutex};
+    if (blocks.size() < max_size) {
+      blocks.emplace_back(block);
+      return;
+    }
+  }
+  ::operator delete(block);
+}
+
+Pool::Pool(size_t max_size, size_t max_capacity) :
+  impl_{std::make_shared<Impl>(max_size, max_capacity)} {
+  impl_->packets.reserve(max_size);
+  impl_->blocks.reserve(max_size);
+}
+
+Pool::~Pool() = default;
+
+std::shared_ptr<Basic> Pool::make() {
+  Basic *packet{nullptr};
+  {
+    std::unique_lock<std::mutex> lock{impl_->mutex};
+    if (!impl_->packets.empty()) {
+      packet = impl_->packets.back();
+      impl_->packets.pop_back();
+    }
+  }
+  if (packet) {
+    impl_->hits.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    impl_->misses.fetch_add(1, std::memory_order_relaxed);
+    packet = new Basic;
+  }
+  return {packet, Impl::Recycler{impl_}, Impl::Allocator<Basic>{impl_}};
+}
+
+uint64_t Pool::hits() const noexcept {
+  return impl_->hits.load(std::memory_order_relaxed);
+}
+
+uint64_t Pool::misses() const noexcept {
+  return impl_->misses.load(std::memory_order_relaxed);
+}
+
+size_t Pool::size() const noexcept {
+  std::unique_lock<std::mutex> lock{impl_->mutex};
+  return impl_->packets.size();
+}
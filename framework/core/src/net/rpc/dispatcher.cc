@@ -1,35 +1,70 @@
 #include "plain/net/rpc/dispatcher.h"
-#include "plain/basic/io.h"
 #include "plain/net/packet/basic.h"
 
 using plain::net::rpc::Dispatcher;
 
-plain::error_or_t<std::shared_ptr<plain::net::rpc::Packer>>
-Dispatcher::dispatch(std::shared_ptr<packet::Basic> pack) {
-  
-  std::string name;
-  *pack >> name;
-  if (name.empty()) return Error{ErrorCode::NetPacketInvalid};
+void Dispatcher::unbind(std::string const &name) {
+  auto it = methods_.find(name);
+  if (it == methods_.end()) return;
+  adaptors_[it->second] = nullptr; // The id not reused.
+  methods_.erase(it);
+}
 
-  auto it = funcs_.find(name);
-  if (it == funcs_.end()) return Error{ErrorCode::NetRpcFunctionNotFound};
+std::vector<std::string> Dispatcher::names() const {
+  std::vector<std::string> names;
+  for (const auto &[name, id] : methods_)
+    names.push_back(name);
+  return names;
+}
 
-  io_cdebug("rpc: [{}] called", name);
+plain::net::rpc::method_id_t
+Dispatcher::method_id(std::string_view name) const noexcept {
+  auto it = methods_.find(name);
+  return it == methods_.end() ? 0 : it->second;
+}
+
+plain::error_or_t<std::shared_ptr<plain::net::rpc::Packer>>
+Dispatcher::dispatch(std::shared_ptr<packet::Basic> pack) {
+  uint32_t length{0};
+  *pack >> length;
+  const adaptor_type *adaptor{nullptr};
+  if (length == 0) {
+    method_id_t id{0};
+    *pack >> id;
+    if (id < adaptors_.size() && adaptors_[id]) adaptor = &adaptors_[id];
+  } else {
+    auto data = pack->data();
+    if (data.size() - pack->offset() < length)
+      return Error{ErrorCode::NetPacketInvalid};
+    std::string_view name{
+      reinterpret_cast<const char *>(data.data() + pack->offset()), length};
+    pack->remove(length);
+    auto it = methods_.find(name);
+    if (it != methods_.end()) adaptor = &adaptors_[it->second];
+  }
+  if (!adaptor) return Error{ErrorCode::NetRpcFunctionNotFound};
 
   auto data = reinterpret_cast<const uint8_t *>(
     pack->data().data() + pack->offset());
   auto size = pack->data().size() - pack->offset();
   Unpacker unpacker(data, size);
 
-  return it->second(unpacker);
+  return (*adaptor)(unpacker);
 }
 
 void Dispatcher::enforce_unique_name(const std::string &name) {
-  auto it = funcs_.find(name);
-  if (it != funcs_.end()) {
+  auto it = methods_.find(name);
+  if (it != methods_.end()) {
     throw std::logic_error(
       std::format(
         "Function name already bound: '{}'. "
         "Please use unique function names", name));
   }
 }
+
+void Dispatcher::add(const std::string &name, adaptor_type adaptor) {
+  if (adaptors_.empty()) adaptors_.emplace_back(); // The id 0 is invalid.
+  auto id = static_cast<method_id_t>(adaptors_.size());
+  adaptors_.emplace_back(std::move(adaptor));
+  methods_.emplace(name, id);
+}
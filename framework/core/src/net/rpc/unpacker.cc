@@ -11,6 +11,12 @@ Unpacker::Unpacker(const uint8_t *data, size_t size) :
 
 }
 
+Unpacker::Unpacker(
+  std::shared_ptr<const void> holder, const uint8_t *data, size_t size) :
+  data_{data}, data_end_{data + size}, holder_{std::move(holder)} {
+
+}
+
 Unpacker::~Unpacker() = default;
 
 void Unpacker::unpack(int8_t &value) noexcept {
@@ -1,7 +1,10 @@
 #include "plain/net/socket/api.h"
 #include <errno.h>
+#include <algorithm>
+#include <array>
 #if OS_UNIX || OS_MAC
 #include <signal.h>
+#include <sys/uio.h>
 #endif
 #include "plain/file/api.h"
 #include "plain/basic/type/config.h"
@@ -370,6 +373,40 @@ int32_t send(id_t id, const void *buffer, uint32_t length, uint32_t flag) {
   return r;
 }
 
+int32_t
+send(id_t id, std::span<const const_byte_span_t> buffers, uint32_t flag) {
+  constexpr size_t kBufferCountMax{16};
+  int32_t r{kSocketError};
+  auto count = std::min(buffers.size(), kBufferCountMax);
+#if OS_UNIX || OS_MAC
+  std::array<iovec, kBufferCountMax> vecs;
+  for (size_t i = 0; i < count; ++i) {
+    vecs[i].iov_base = const_cast<std::byte *>(buffers[i].data());
+    vecs[i].iov_len = buffers[i].size();
+  }
+  msghdr msg{};
+  msg.msg_iov = vecs.data();
+  msg.msg_iovlen = count;
+  r = static_cast<int32_t>(::sendmsg(id, &msg, flag));
+#elif OS_WIN
+  std::array<WSABUF, kBufferCountMax> vecs;
+  for (size_t i = 0; i < count; ++i) {
+    vecs[i].buf =
+      reinterpret_cast<char *>(const_cast<std::byte *>(buffers[i].data()));
+    vecs[i].len = static_cast<ULONG>(buffers[i].size());
+  }
+  DWORD sent{0};
+  if (::WSASend(id, vecs.data(), static_cast<DWORD>(count), &sent,
+      flag, nullptr, nullptr) == 0)
+    r = static_cast<int32_t>(sent);
+#endif
+  if (r == kSocketError) {
+    set_error();
+    if (s_error.code() == kErrorWouldBlock) r = kErrorWouldBlock;
+  }
+  return r;
+}
+
 int32_t sendto(
   id_t id, const void *buffer, int32_t length, uint32_t flag,
   const sockaddr *to, int32_t tolength) {
@@ -401,6 +438,39 @@ int32_t recv(id_t id, void *buffer, uint32_t length, uint32_t flag) {
   return r;
 }
 
+int32_t recv(id_t id, std::span<const byte_span_t> buffers, uint32_t flag) {
+  constexpr size_t kBufferCountMax{16};
+  int32_t r{kSocketError};
+  auto count = std::min(buffers.size(), kBufferCountMax);
+#if OS_UNIX || OS_MAC
+  std::array<iovec, kBufferCountMax> vecs;
+  for (size_t i = 0; i < count; ++i) {
+    vecs[i].iov_base = buffers[i].data();
+    vecs[i].iov_len = buffers[i].size();
+  }
+  msghdr msg{};
+  msg.msg_iov = vecs.data();
+  msg.msg_iovlen = count;
+  r = static_cast<int32_t>(::recvmsg(id, &msg, flag));
+#elif OS_WIN
+  std::array<WSABUF, kBufferCountMax> vecs;
+  for (size_t i = 0; i < count; ++i) {
+    vecs[i].buf = reinterpret_cast<char *>(buffers[i].data());
+    vecs[i].len = static_cast<ULONG>(buffers[i].size());
+  }
+  DWORD received{0};
+  DWORD flags{flag};
+  if (::WSARecv(id, vecs.data(), static_cast<DWORD>(count), &received,
+      &flags, nullptr, nullptr) == 0)
+    r = static_cast<int32_t>(received);
+#endif
+  if (r == kSocketError) {
+    set_error();
+    if (s_error.code() == kErrorWouldBlock) r = kErrorWouldBlock;
+  }
+  return r;
+}
+
 int32_t recvfrom(
   id_t id, void *buffer, int32_t length, uint32_t flag, sockaddr *from,
   uint32_t *fromlength) {
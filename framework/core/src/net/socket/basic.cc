@@ -78,12 +78,22 @@ int32_t Basic::send(const bytes_t &bytes, uint32_t flag) {
   return socket::send(impl_->id, bytes.data(), size, flag);
 }
   
+int32_t Basic::send(std::span<const const_byte_span_t> buffers, uint32_t flag) {
+  if (!valid()) return 0;
+  return socket::send(impl_->id, buffers, flag);
+}
+  
 int32_t Basic::recv(bytes_t &bytes, uint32_t flag) {
   if (!valid()) return 0;
   auto size = static_cast<uint32_t>(bytes.capacity());
   return socket::recv(impl_->id, bytes.data(), size, flag);
 }
   
+int32_t Basic::recv(std::span<const byte_span_t> buffers, uint32_t flag) {
+  if (!valid()) return 0;
+  return socket::recv(impl_->id, buffers, flag);
+}
+  
 size_t Basic::avail() const noexcept {
   if (!valid()) return 0;
   return socket::available(impl_->id);
@@ -207,6 +217,16 @@ bool Basic::set_reuse_addr(bool on) const noexcept {
   return r;
 }
   
+bool Basic::set_reuse_port([[maybe_unused]] bool on) const noexcept {
+#if defined(SO_REUSEPORT)
+  int32_t option = true == on ? 1 : 0;
+  return setsockopt(
+    impl_->id, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option));
+#else
+  return false;
+#endif
+}
+  
 bool Basic::listen(uint32_t backlog) {
   if (!valid()) return false;
   return socket::listen(impl_->id, backlog);
@@ -32,7 +32,7 @@ IoUring::IoUring() = default;
 IoUring::~IoUring() = default;
 
 Awaitable
-IoUring::send_await(const bytes_t &bytes, uint32_t flag, void *udata) {
+IoUring::send_await(const_byte_span_t bytes, uint32_t flag, void *udata) {
 #ifdef PLAIN_LIBURING_ENABLE
   auto sqe = static_cast<io_uring_sqe *>(udata);
   io_uring_prep_send(sqe, this->id(), bytes.data(), bytes.size(), 0);
@@ -45,7 +45,7 @@ IoUring::send_await(const bytes_t &bytes, uint32_t flag, void *udata) {
 #endif
 }
 
-Awaitable IoUring::recv_await(bytes_t &bytes, uint32_t flag, void *udata) {
+Awaitable IoUring::recv_await(byte_span_t bytes, uint32_t flag, void *udata) {
 #ifdef PLAIN_LIBURING_ENABLE
   auto sqe = static_cast<io_uring_sqe *>(udata);
   io_uring_prep_recv(sqe, this->id(), bytes.data(), bytes.size(), 0);
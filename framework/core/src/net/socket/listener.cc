@@ -12,7 +12,8 @@ Listener::Listener() : socket_{std::make_unique<plain::net::socket::Basic>()} {
 Listener::~Listener() = default;
 
 bool Listener::init(
-  const Address &addr, socket::Type sock_type, uint32_t backlog) {
+  const Address &addr, socket::Type sock_type, uint32_t backlog,
+  bool reuse_port) {
   if (!socket_->close()) return false;
   auto socket_type = get_sock_type(sock_type);
   if (!socket_->create(addr.family(), socket_type, 0)) {
@@ -23,6 +24,10 @@ bool Listener::init(
     LOG_ERROR << "can't set reuse addr: " << get_last_error();
     return false;
   }
+  if (reuse_port && !socket_->set_reuse_port()) {
+    LOG_ERROR << "can't set reuse port: " << get_last_error();
+    return false;
+  }
   if (!socket_->bind(addr)) {
     LOG_ERROR << "can't bind addr: " << addr.text()
       << " error: " << get_last_error();
@@ -1,6 +1,12 @@
 #include "plain/net/stream/basic.h"
+#include <algorithm>
 #include <cassert>
+#include <deque>
+#include <limits>
 #include "plain/basic/ring.h"
+#include "plain/net/constants.h"
+#include "plain/net/packet/basic.h"
+#include "plain/net/packet/pool.h"
 #include "plain/net/socket/api.h"
 #include "plain/net/socket/basic.h"
 
@@ -8,11 +14,62 @@ using plain::net::stream::Basic;
 using plain::net::socket::kErrorWouldBlock;
 using plain::net::socket::kSocketError;
 
+namespace {
+
+// Limit the ring blocks total size to count.
+template <typename T>
+std::array<std::span<T>, 2>
+limit_blocks(std::array<std::span<T>, 2> blocks, size_t count) noexcept {
+  if (blocks[0].size() >= count) {
+    blocks[0] = blocks[0].first(count);
+    blocks[1] = {};
+  } else if (blocks[0].size() + blocks[1].size() > count) {
+    blocks[1] = blocks[1].first(count - blocks[0].size());
+  }
+  return blocks;
+}
+
+} // namespace
+
 struct Basic::Impl {
   std::weak_ptr<socket::Basic> weak_socket;
   DynamicRing<std::byte, 128> buffer;
   std::string encrypt_key;
   bool compressed{false};
+  // The read slices slab, reused when the slices of it all released.
+  struct slab_struct {
+    bytes_t bytes;
+    std::atomic_bool released{true};
+  };
+  std::shared_ptr<slab_struct> slab;
+  std::shared_ptr<const bytes_t> slab_owner; // The slices owner.
+  size_t slab_offset{0};
+  static constexpr size_t kSlabSize{64 * 1024};
+  // The buffer for writing, moved to a new storage if the read slices
+  // still borrow it.
+  DynamicRing<std::byte, 128> &writable() {
+    buffer.detach();
+    return buffer;
+  }
+  std::shared_ptr<packet::Pool> packet_pool;
+  bool drained{false};
+  // The shared blocks(output only) in order with the buffer, each one after
+  // the before bytes of the buffer(behind the previous one).
+  struct shared_block_struct {
+    std::shared_ptr<const bytes_t> bytes;
+    size_t offset{0}; // Removed.
+    size_t before{0};
+  };
+  std::deque<shared_block_struct> shared_blocks;
+  size_t shared_size{0}; // The shared bytes not removed.
+  size_t shared_before{0}; // The before bytes total.
+  static constexpr size_t kGatherMax{16}; // The socket send buffers max.
+  // The small copied, a send buffer each one costs more than the copy.
+  static constexpr size_t kSharedSizeMin{1024};
+  size_t gather(
+    std::array<const_byte_span_t, kGatherMax> &buffers,
+    size_t max) const noexcept;
+  size_t remove(size_t length) noexcept;
 #if OS_WIN
   static constexpr uint32_t kSendFlag{MSG_DONTROUTE};
 #else
@@ -21,6 +78,66 @@ struct Basic::Impl {
 
 };
 
+// The readable bytes prefix(not more than max) in order.
+size_t Basic::Impl::gather(
+  std::array<const_byte_span_t, kGatherMax> &buffers,
+  size_t max) const noexcept {
+  auto blocks = buffer.read_blocks();
+  size_t count{0};
+  size_t total{0};
+  size_t buffer_offset{0};
+  auto add = [&buffers, &count, &total, max](const_byte_span_t bytes) {
+    if (bytes.empty() || count >= kGatherMax || total >= max) return;
+    bytes = bytes.first(std::min(bytes.size(), max - total));
+    buffers[count++] = bytes;
+    total += bytes.size();
+  };
+  auto add_buffer = [&blocks, &buffer_offset, &add](size_t length) {
+    auto first_size = blocks[0].size();
+    if (buffer_offset < first_size) {
+      auto size = std::min(length, first_size - buffer_offset);
+      add(blocks[0].subspan(buffer_offset, size));
+      buffer_offset += size;
+      length -= size;
+    }
+    if (length > 0) {
+      add(blocks[1].subspan(buffer_offset - first_size, length));
+      buffer_offset += length;
+    }
+  };
+  for (const auto &block : shared_blocks) {
+    add_buffer(block.before);
+    add(const_byte_span_t{*block.bytes}.subspan(block.offset));
+    if (count >= kGatherMax || total >= max) return count;
+  }
+  add_buffer(buffer.read_avail() - buffer_offset);
+  return count;
+}
+
+size_t Basic::Impl::remove(size_t length) noexcept {
+  size_t r{0};
+  while (length > 0 && !shared_blocks.empty()) {
+    auto &block = shared_blocks.front();
+    if (block.before > 0) {
+      auto size = buffer.remove(std::min(length, block.before));
+      if (size == 0) return r;
+      block.before -= size;
+      shared_before -= size;
+      length -= size;
+      r += size;
+      continue;
+    }
+    auto size = std::min(length, block.bytes->size() - block.offset);
+    block.offset += size;
+    shared_size -= size;
+    length -= size;
+    r += size;
+    if (block.offset == block.bytes->size()) shared_blocks.pop_front();
+  }
+  if (length > 0) r += buffer.remove(length);
+  return r;
+}
+
 Basic::Basic(std::shared_ptr<socket::Basic> socket) :
   impl_{std::make_unique<Impl>()} {
   impl_->weak_socket = socket;
@@ -28,49 +145,75 @@ Basic::Basic(std::shared_ptr<socket::Basic> socket) :
 
 Basic::~Basic() = default;
 
-int32_t Basic::pull() noexcept {
+int32_t Basic::pull(size_t budget) noexcept {
   auto socket = impl_->weak_socket.lock();
   if (!socket || !socket->valid()) return 0;
-  auto socket_avail = socket->avail();
-  if (socket_avail == 0) socket_avail = 1;
-  // auto once_max = impl_->buffer.write_avail() + impl_->buffer.size();
-  constexpr size_t once_max{20 * 1024}; // 20k
-  bytes_t bytes;
-  bytes.reserve(socket_avail >= once_max ? once_max : socket_avail);
-  auto e = socket->recv(bytes);
-  if (e == kErrorWouldBlock) return 0;
-  if (e == kSocketError) return kSocketError - 1;
-  if (e == 0) return kSocketError - 2;
-  uint32_t size = e;
-  auto read_size = impl_->buffer.write(bytes.data(), size);
-  if (read_size < size) return kSocketError - 3;
-  return static_cast<int32_t>(read_size);
+  impl_->drained = false;
+  constexpr size_t once_min{4 * 1024}; // 4k
+  // The zero budget use the default(not grow the ring without limit).
+  if (budget == 0) budget = kRecvBudgetSize;
+  budget = std::min<size_t>(budget, std::numeric_limits<int32_t>::max());
+  size_t total{0};
+  for (;;) {
+    // Receive into the ring free blocks directly(no temp buffer).
+    auto count = std::max(impl_->buffer.write_avail(), once_min);
+    count = std::min(count, budget - total);
+    auto blocks = limit_blocks(impl_->writable().write_blocks(count), count);
+    if (blocks[0].empty()) return kSocketError - 3;
+    auto e = socket->recv(blocks);
+    if (e == kErrorWouldBlock) {
+      impl_->drained = true;
+      break;
+    }
+    if (e == kSocketError) return kSocketError - 1;
+    if (e == 0) { // Closed, the received handle first.
+      if (total > 0) break;
+      return kSocketError - 2;
+    }
+    uint32_t size = e;
+    auto read_size = impl_->buffer.commit(size);
+    if (read_size < size) return kSocketError - 3;
+    total += read_size;
+    // The short read means no more(edge triggered will notify the new).
+    if (read_size < blocks[0].size() + blocks[1].size()) {
+      impl_->drained = true;
+      break;
+    }
+    if (total >= budget) break;
+  }
+  return static_cast<int32_t>(total);
+}
+
+bool Basic::drained() const noexcept {
+  return impl_->drained;
+}
+
+int32_t Basic::pull(const_byte_span_t bytes) noexcept {
+  auto size = impl_->writable().write(bytes.data(), bytes.size(), true);
+  if (size < bytes.size()) return kSocketError - 3;
+  return static_cast<int32_t>(size);
 }
 
 int32_t Basic::push() noexcept {
   // std::cout << "push" << this << std::endl;
   auto socket = impl_->weak_socket.lock();
   if (!socket || !socket->valid()) return 0;
-  auto send_size = impl_->buffer.read_avail();
-  // std::cout << "need size: " << send_size << std::endl;
-  if (send_size == 0) return 0;
-  constexpr auto once_max = 1024 * 1024; // once max send 1m
-  if (send_size > once_max)
-    send_size = once_max;
-  bytes_t bytes;
-  bytes.resize(send_size);
-  send_size = impl_->buffer.read(bytes.data(), send_size, true); // Read to temp.
-  // std::cout << "push value: " << (char *)bytes.data() << std::endl;
-  decltype(send_size) real_send_size{0};
+  constexpr size_t once_max = 1024 * 1024; // once max send 1m
+  // Send the ring blocks(and the shared) directly and remove the sended(no
+  // temp buffer).
+  size_t real_send_size{0};
   for (uint16_t i = 0; i < 99; ++i) {
-    if (real_send_size >= send_size) break;
-    bytes_t temp;
-    temp.insert(0, bytes.data() + real_send_size, send_size - real_send_size);
-    auto send_result = socket->send(temp, Impl::kSendFlag);
+    if (real_send_size >= once_max) break;
+    std::array<const_byte_span_t, Impl::kGatherMax> buffers;
+    auto count = impl_->gather(buffers, once_max - real_send_size);
+    if (count == 0) break;
+    auto send_result = socket->send(
+      std::span<const const_byte_span_t>{buffers.data(), count},
+      Impl::kSendFlag);
     if (send_result == kErrorWouldBlock || send_result == 0) break;
     if (send_result == kSocketError) return kSocketError - 1;
     assert(send_result > 0);
-    impl_->buffer.remove(send_result); // Sended then remove of buffer.
+    impl_->remove(send_result); // Sended then remove of buffer.
     real_send_size += send_result;
   }
   return static_cast<int32_t>(real_send_size);
@@ -79,17 +222,19 @@ int32_t Basic::push() noexcept {
 plain::net::detail::Task<int32_t> Basic::pull_await(void *udata) noexcept {
   auto socket = impl_->weak_socket.lock();
   if (!socket || !socket->valid()) co_return 0;
-  auto socket_avail = socket->avail();
-  if (socket_avail == 0) socket_avail = 1;
-  auto once_max = impl_->buffer.write_avail() + impl_->buffer.size();
-  bytes_t bytes;
-  bytes.reserve(socket_avail >= once_max ? once_max : socket_avail);
-  auto e = co_await socket->recv_await(bytes);
+  // Receive into the ring first free block directly(the awaitable socket
+  // receive one buffer once, no temp buffer).
+  constexpr size_t once_min{4 * 1024}; // 4k
+  auto count = std::min<size_t>(
+    std::max(impl_->buffer.write_avail(), once_min), kRecvBudgetSize);
+  auto blocks = limit_blocks(impl_->writable().write_blocks(count), count);
+  if (blocks[0].empty()) co_return kSocketError - 3;
+  auto e = co_await socket->recv_await(blocks[0], 0, udata);
   if (e == kErrorWouldBlock) co_return 0;
   if (e == kSocketError) co_return kSocketError - 1;
   if (e == 0) co_return kSocketError - 2;
   uint32_t size = e;
-  auto read_size = impl_->buffer.write(bytes.data(), size);
+  auto read_size = impl_->buffer.commit(size);
   if (read_size < size) co_return kSocketError - 3;
   co_return static_cast<int32_t>(read_size);
 }
@@ -97,26 +242,21 @@ plain::net::detail::Task<int32_t> Basic::pull_await(void *udata) noexcept {
 plain::net::detail::Task<int32_t> Basic::push_await(void *udata) noexcept {
   auto socket = impl_->weak_socket.lock();
   if (!socket || !socket->valid()) co_return 0;
-  auto send_size = impl_->buffer.read_avail();
-  // std::cout << "need size: " << send_size << std::endl;
-  if (send_size == 0) co_return 0;
-  constexpr auto once_max = 1024;
-  if (send_size > once_max)
-    send_size = once_max;
-  bytes_t bytes;
-  bytes.resize(send_size);
-  send_size = impl_->buffer.read(bytes.data(), send_size, true); // Read to temp.
-  // std::cout << "push value: " << (char *)bytes.data() << std::endl;
-  decltype(send_size) real_send_size{0};
+  constexpr size_t once_max = 1024 * 1024;
+  // Each block(and the shared) send in place, the awaitable socket send one
+  // buffer once.
+  size_t real_send_size{0};
   for (uint16_t i = 0; i < 99; ++i) {
-    if (real_send_size >= send_size) break;
-    bytes_t temp;
-    temp.insert(0, bytes.data() + real_send_size, send_size - real_send_size);
-    auto send_result = co_await socket->send_await(temp, Impl::kSendFlag);
+    if (real_send_size >= once_max) break;
+    auto block = read_block();
+    if (block.empty()) break;
+    block = block.first(std::min(block.size(), once_max - real_send_size));
+    auto send_result = co_await socket->send_await(
+      block, Impl::kSendFlag, udata);
     if (send_result == kErrorWouldBlock || send_result == 0) break;
     if (send_result == kSocketError) co_return kSocketError - 1;
     assert(send_result > 0);
-    impl_->buffer.remove(send_result); // Sended then remove of buffer.
+    impl_->remove(send_result); // Sended then remove of buffer.
     real_send_size += send_result;
   }
   co_return static_cast<int32_t>(real_send_size);
@@ -127,15 +267,18 @@ bool Basic::full() const noexcept {
 }
 
 bool Basic::empty() const noexcept {
-  return impl_->buffer.empty();
+  return impl_->buffer.empty() && impl_->shared_blocks.empty();
 }
   
 size_t Basic::size() const noexcept {
-  return impl_->buffer.read_avail();
+  return impl_->buffer.read_avail() + impl_->shared_size;
 }
   
 void Basic::clear() noexcept {
   impl_->buffer.consumer_clear();
+  impl_->shared_blocks.clear();
+  impl_->shared_size = 0;
+  impl_->shared_before = 0;
 }
   
 std::shared_ptr<plain::net::socket::Basic> Basic::socket() {
@@ -160,15 +303,15 @@ void Basic::set_compress(bool on) noexcept {
 
 size_t Basic::write(std::string_view str) {
   const auto *buffer = reinterpret_cast<const std::byte *>(str.data());
-  return impl_->buffer.write(buffer, str.size(), true);
+  return impl_->writable().write(buffer, str.size(), true);
 }
 
 size_t Basic::write(const bytes_t &bytes) {
-  return impl_->buffer.write(bytes.data(), bytes.size(), true);
+  return impl_->writable().write(bytes.data(), bytes.size(), true);
 }
 
 size_t Basic::write(const_byte_span_t bytes) {
-  return impl_->buffer.write(bytes.data(), bytes.size(), true);
+  return impl_->writable().write(bytes.data(), bytes.size(), true);
 }
 
 size_t Basic::read(std::string &str) {
@@ -187,11 +330,94 @@ size_t Basic::read(std::byte *value, size_t length) {
   return impl_->buffer.read(value, length);
 }
 
+plain::const_byte_span_t Basic::read_block() const noexcept {
+  if (!impl_->shared_blocks.empty()) {
+    const auto &block = impl_->shared_blocks.front();
+    if (block.before == 0)
+      return const_byte_span_t{*block.bytes}.subspan(block.offset);
+    return limit_blocks(impl_->buffer.read_blocks(), block.before)[0];
+  }
+  return impl_->buffer.read_blocks()[0];
+}
+
 size_t Basic::remove(size_t length) noexcept {
-  return impl_->buffer.remove(length);
+  return impl_->remove(length);
+}
+
+bool Basic::write(std::shared_ptr<const bytes_t> bytes) noexcept {
+  if (!bytes || bytes->empty()) return false;
+  if (bytes->size() < Impl::kSharedSizeMin)
+    return write(const_byte_span_t{*bytes}) == bytes->size();
+  auto before = impl_->buffer.read_avail() - impl_->shared_before;
+  impl_->shared_before += before;
+  impl_->shared_size += bytes->size();
+  impl_->shared_blocks.push_back({std::move(bytes), 0, before});
+  return true;
 }
   
 size_t Basic::peek(std::byte *value, size_t length) {
   if (!value) return 0;
   return impl_->buffer.read(value, length, true);
 }
+
+std::array<plain::byte_span_t, 2> Basic::reserve(size_t length) noexcept {
+  return limit_blocks(impl_->writable().write_blocks(length), length);
+}
+
+size_t Basic::commit(size_t length) noexcept {
+  return impl_->buffer.commit(length);
+}
+
+plain::const_byte_span_t
+Basic::read_slice(
+  size_t length, std::shared_ptr<const bytes_t> &owner, size_t *copied) {
+  if (length == 0 || length > impl_->buffer.read_avail()) return {};
+  // The contiguous borrowed in place(no copy), the writing moves the buffer
+  // if it still borrowed.
+  auto block = impl_->buffer.read_block();
+  if (block.size() >= length) {
+    static const bytes_t kOwnerAlias; // The owner only keep the storage.
+    owner = std::shared_ptr<const bytes_t>{
+      impl_->buffer.storage(), &kOwnerAlias};
+    impl_->buffer.remove(length);
+    return block.first(length);
+  }
+  // The wrapped copied.
+  if (copied) *copied = length;
+  if (length > Impl::kSlabSize / 4) { // The large one use itself slab.
+    auto temp = std::make_shared<bytes_t>();
+    temp->resize(length);
+    impl_->buffer.read(temp->data(), length);
+    owner = temp;
+    return as_const_bytes(*temp);
+  }
+  auto &slab = impl_->slab;
+  auto &slab_owner = impl_->slab_owner;
+  if (!slab_owner || impl_->slab_offset + length > Impl::kSlabSize) {
+    slab_owner.reset(); // Released here if no slice alive.
+    if (!slab || !slab->released.load(std::memory_order_acquire)) {
+      slab = std::make_shared<Impl::slab_struct>();
+      slab->bytes.resize(Impl::kSlabSize);
+    }
+    slab->released.store(false, std::memory_order_relaxed);
+    slab_owner = std::shared_ptr<const bytes_t>(
+      &slab->bytes, [slab](const bytes_t *) {
+        slab->released.store(true, std::memory_order_release);
+      });
+    impl_->slab_offset = 0;
+  }
+  auto data = slab->bytes.data() + impl_->slab_offset;
+  impl_->buffer.read(data, length);
+  impl_->slab_offset += length;
+  owner = slab_owner;
+  return {data, length};
+}
+
+void Basic::set_packet_pool(std::shared_ptr<packet::Pool> pool) noexcept {
+  impl_->packet_pool = std::move(pool);
+}
+
+std::shared_ptr<plain::net::packet::Basic> Basic::new_packet() {
+  if (impl_->packet_pool) return impl_->packet_pool->make();
+  return std::make_shared<packet::Basic>();
+}
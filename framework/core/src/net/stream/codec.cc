@@ -13,6 +13,24 @@ struct head_t {
 #pragma pack(pop)
 static constexpr size_t kHeaderSize{sizeof(head_t)};
 
+// Copy the bytes into the reserved blocks at offset, return the next offset.
+static size_t put(
+  const std::array<byte_span_t, 2> &blocks, size_t offset,
+  const_byte_span_t bytes) noexcept {
+  auto first = blocks[0].size();
+  size_t size{0};
+  if (offset < first) {
+    size = std::min(bytes.size(), first - offset);
+    std::memcpy(blocks[0].data() + offset, bytes.data(), size);
+  }
+  if (size < bytes.size()) {
+    std::memcpy(
+      blocks[1].data() + (offset + size - first), bytes.data() + size,
+      bytes.size() - size);
+  }
+  return offset + bytes.size();
+}
+
 bytes_t encode(std::shared_ptr<packet::Basic> packet) {
   bytes_t r;
   auto d = packet->data();
@@ -24,6 +42,79 @@ bytes_t encode(std::shared_ptr<packet::Basic> packet) {
   return r;
 }
 
+bool encode_to(Basic *output, const packet::Basic &packet) {
+  if (!output) return false;
+  auto d = packet.data();
+  head_t head;
+  head.id = hton(packet.id());
+  head.length = hton(static_cast<length_t>(d.size()));
+  auto length = kHeaderSize + d.size();
+  auto blocks = output->reserve(length);
+  if (blocks[0].size() + blocks[1].size() < length) return false;
+  auto offset = put(blocks, 0, as_const_bytes(&head, kHeaderSize));
+  put(blocks, offset, d);
+  return output->commit(length) == length;
+}
+
+size_t batch_size(const packet::Basic &packet) noexcept {
+  return kHeaderSize + packet.data().size();
+}
+
+bool encode_batch_to(
+  Basic *output, std::span<const std::shared_ptr<packet::Basic>> packets) {
+  if (!output) return false;
+  size_t length{0};
+  for (const auto &packet : packets) length += batch_size(*packet);
+  head_t head;
+  head.id = hton(packet::kRpcBatchId);
+  head.length = hton(static_cast<length_t>(length));
+  length += kHeaderSize;
+  auto blocks = output->reserve(length);
+  if (blocks[0].size() + blocks[1].size() < length) return false;
+  auto offset = put(blocks, 0, as_const_bytes(&head, kHeaderSize));
+  for (const auto &packet : packets) {
+    auto d = packet->data();
+    head.id = hton(packet->id());
+    head.length = hton(static_cast<length_t>(d.size()));
+    offset = put(blocks, offset, as_const_bytes(&head, kHeaderSize));
+    offset = put(blocks, offset, d);
+  }
+  return output->commit(length) == length;
+}
+
+bool decode_batch(
+  Basic *input, const std::shared_ptr<packet::Basic> &batch,
+  const std::function<bool(std::shared_ptr<packet::Basic>)> &func) {
+  if (!input || !batch) return false;
+  // The owner only keep the batch alive.
+  static const bytes_t kOwnerAlias;
+  std::shared_ptr<const bytes_t> owner{batch, &kOwnerAlias};
+  auto d = batch->data().subspan(batch->offset());
+  while (!d.empty()) {
+    head_t head;
+    if (d.size() < kHeaderSize) return false;
+    std::memcpy(&head, d.data(), kHeaderSize);
+    head.id = ntoh(head.id);
+    head.length = ntoh(head.length);
+    if (head.id == 0 || head.id == packet::kRpcBatchId ||
+        d.size() - kHeaderSize < head.length) return false;
+    auto p = input->new_packet();
+    p->set_id(head.id);
+    p->set_data(owner, d.subspan(kHeaderSize, head.length));
+    p->set_readable(true);
+    if (head.id == packet::kRpcRequestId) {
+      p->set_call_request(true);
+    } else if (head.id == packet::kRpcResponseId) {
+      p->set_call_response(true);
+    } else if (head.id == packet::kRpcNotifyId) {
+      p->set_call_notify(true);
+    }
+    if (!func(std::move(p))) return false;
+    d = d.subspan(kHeaderSize + head.length);
+  }
+  return true;
+}
+
 error_or_t<std::shared_ptr<packet::Basic>>
 decode(Basic *input, const packet::limit_t &packet_limit) {
   if (!input) {
@@ -45,19 +136,17 @@ decode(Basic *input, const packet::limit_t &packet_limit) {
   if (head.length + kHeaderSize > input->size()) {
     return Error{ErrorCode::NetPacketNeedRecv, ""};
   }
-  auto p = std::make_shared<packet::Basic>();
+  auto p = input->new_packet();
   p->set_id(head.id);
-  p->set_writeable(true);
-  bytes_t bytes;
-  bytes.resize(head.length);
   input->remove(kHeaderSize);
-  auto size = input->read(bytes.data(), head.length);
-  // std::cout << "read: " << size << "|" << (char *)bytes.data() << std::endl;
-  if (size != head.length) {
+  // The packet borrow the data from input(the wrapped copied to the slab).
+  std::shared_ptr<const bytes_t> owner;
+  size_t copied{0};
+  auto data = input->read_slice(head.length, owner, &copied);
+  if (data.size() != head.length) {
     return Error{ErrorCode::RunTime, ""};
   }
-  p->write(bytes.data(), bytes.size());
-  p->set_writeable(false);
+  p->set_data(std::move(owner), data, copied);
   p->set_readable(true);
   if (head.id == packet::kRpcRequestId) {
     p->set_call_request(true);
@@ -106,7 +195,7 @@ line_decode(stream::Basic *input, const packet::limit_t &packet_limit) {
   if (pos > 0 && str[pos - 1] == '\r') {
     pos -= 1;
   }
-  auto p = std::make_shared<packet::Basic>();
+  auto p = input->new_packet();
 
   // For rpc
   if (pos >= kRpcRequestSizeMin &&
@@ -153,4 +242,29 @@ bytes_t line_encode(std::shared_ptr<packet::Basic> packet) {
   return r;
 }
 
+bool line_encode_to(Basic *output, const packet::Basic &packet) {
+  if (!output) return false;
+  auto d = packet.data();
+  const_byte_span_t begin, end;
+  if (packet.is_call_request()) {
+    begin = as_const_bytes(kRpcRequestBegin);
+    end = as_const_bytes(kRpcRequestEnd);
+  } else if (packet.is_call_response()) {
+    begin = as_const_bytes(kRpcResponseBegin);
+    end = as_const_bytes(kRpcResponseEnd);
+  } else if (packet.is_call_notify()) {
+    begin = as_const_bytes(kRpcNotifyBegin);
+    end = as_const_bytes(kRpcNotifyEnd);
+  }
+  static constexpr std::byte kLineEnd{'\n'};
+  auto length = begin.size() + d.size() + end.size() + 1;
+  auto blocks = output->reserve(length);
+  if (blocks[0].size() + blocks[1].size() < length) return false;
+  auto offset = put(blocks, 0, begin);
+  offset = put(blocks, offset, d);
+  offset = put(blocks, offset, end);
+  put(blocks, offset, as_const_bytes(&kLineEnd, 1));
+  return output->commit(length) == length;
+}
+
 } // namespace plain::net::stream
@@ -1,5 +1,10 @@
 #include "plain/sys/thread.h"
 #include "plain/basic/logger.h"
+#if OS_UNIX
+#include <pthread.h>
+#include <sched.h>
+#include <filesystem>
+#endif
 
 namespace plain {
 
@@ -39,6 +44,66 @@ std::uintptr_t get_current_virtual_id() noexcept {
   return detail::s_tl_thread_per_data.id;
 }
 
+bool set_affinity(const std::vector<int32_t> &cpus) noexcept {
+  if (cpus.empty()) return false;
+#if OS_UNIX
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &set);
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#elif OS_WIN
+  DWORD_PTR mask{0};
+  for (auto cpu : cpus) {
+    if (cpu < 0 || cpu >= static_cast<int32_t>(sizeof(mask) * 8)) return false;
+    mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+  return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+#else
+  return false; // The mac only have the affinity tag hints.
+#endif
+}
+
+std::vector<int32_t> get_affinity() noexcept {
+  std::vector<int32_t> r;
+#if OS_UNIX
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set) != 0)
+    return r;
+  for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) r.emplace_back(cpu);
+  }
+#else
+  for (size_t cpu = 0; cpu < hardware_concurrency(); ++cpu)
+    r.emplace_back(static_cast<int32_t>(cpu));
+#endif
+  return r;
+}
+
+int32_t numa_node(int32_t cpu) noexcept {
+#if OS_UNIX
+  // The cpu directory have the link "nodeN" when the kernel have numa.
+  std::error_code ec;
+  std::filesystem::directory_iterator it{
+    "/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec};
+  if (ec) return -1;
+  for (; !ec && it != std::filesystem::directory_iterator{};
+      it.increment(ec)) {
+    auto name = it->path().filename().string();
+    if (name.size() > 4 && name.starts_with("node") &&
+        std::isdigit(static_cast<unsigned char>(name[4])))
+      return std::atoi(name.c_str() + 4);
+  }
+  return -1; // No numa(or the kernel not show it).
+#else
+  UNUSED(cpu);
+  return -1;
+#endif
+}
+
 } // namespace thread
 
 std::atomic<int32_t> ThreadCollect::count_{0};
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include <thread>
+#include "plain/basic/mpsc_queue.h"
+
+class TMpscQueue : public testing::Test {
+
+ public:
+   static void SetUpTestCase() {
+     //Normal.
+   }
+
+   static void TearDownTestCase() {
+     //std::cout << "TearDownTestCase" << std::endl;
+   }
+
+ public:
+
+   virtual void SetUp() {
+   }
+
+   virtual void TearDown() {
+   }
+
+};
+
+void mpsc_queue_order() {
+  plain::MpscQueue<std::unique_ptr<int32_t>> queue;
+  ASSERT_TRUE(queue.empty());
+  for (int32_t i = 0; i < 10; ++i)
+    queue.push(std::make_unique<int32_t>(i));
+  ASSERT_FALSE(queue.empty());
+  int32_t expected{0};
+  auto count = queue.consume([&expected](std::unique_ptr<int32_t> value) {
+    ASSERT_EQ(*value, expected++);
+  });
+  ASSERT_EQ(count, 10);
+  ASSERT_TRUE(queue.empty());
+  queue.push(std::make_unique<int32_t>(1));
+  queue.clear();
+  ASSERT_TRUE(queue.empty());
+}
+
+void mpsc_queue_producers() {
+  static constexpr int32_t kProducerCount{4};
+  static constexpr int32_t kPushCount{10000};
+  plain::MpscQueue<int32_t> queue;
+  std::vector<std::thread> producers;
+  for (int32_t i = 0; i < kProducerCount; ++i) {
+    producers.emplace_back([&queue, i] {
+      for (int32_t j = 0; j < kPushCount; ++j)
+        queue.push(i * kPushCount + j);
+    });
+  }
+  // Each producer's values keep the push order.
+  std::vector<int32_t> last(kProducerCount, -1);
+  int64_t count{0};
+  while (count < kProducerCount * kPushCount) {
+    count += queue.consume([&last](int32_t value) {
+      auto producer = value / kPushCount;
+      ASSERT_LT(last[producer], value);
+      last[producer] = value;
+    });
+  }
+  for (auto &producer : producers) producer.join();
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST_F(TMpscQueue, testOrder) {
+  mpsc_queue_order();
+}
+
+TEST_F(TMpscQueue, testProducers) {
+  mpsc_queue_producers();
+}
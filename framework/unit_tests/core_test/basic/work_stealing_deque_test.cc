@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include <thread>
+#include "plain/basic/work_stealing_deque.h"
+
+class TWorkStealingDeque : public testing::Test {
+
+ public:
+   static void SetUpTestCase() {
+     //Normal.
+   }
+
+   static void TearDownTestCase() {
+     //std::cout << "TearDownTestCase" << std::endl;
+   }
+
+ public:
+
+   virtual void SetUp() {
+   }
+
+   virtual void TearDown() {
+   }
+
+};
+
+void work_stealing_deque_order() {
+  plain::WorkStealingDeque<int32_t> deque{4};
+  ASSERT_TRUE(deque.empty());
+  ASSERT_FALSE(deque.pop());
+  ASSERT_FALSE(deque.steal());
+  for (int32_t i = 0; i < 10; ++i) // Grow from 4.
+    deque.push(i);
+  ASSERT_EQ(deque.size(), 10);
+  ASSERT_EQ(deque.capacity(), 16);
+
+  // The owner last in first out, the thief first in first out.
+  ASSERT_EQ(deque.pop(), 9);
+  ASSERT_EQ(deque.steal(), 0);
+  ASSERT_EQ(deque.steal(), 1);
+  ASSERT_EQ(deque.pop(), 8);
+  ASSERT_EQ(deque.size(), 6);
+  deque.reallocate(); // Keep the values and the capacity.
+  ASSERT_EQ(deque.capacity(), 16);
+  ASSERT_EQ(deque.steal(), 2);
+  ASSERT_EQ(deque.pop(), 7);
+  while (deque.pop()) {}
+  ASSERT_TRUE(deque.empty());
+  ASSERT_FALSE(deque.steal());
+}
+
+void work_stealing_deque_thieves() {
+  static constexpr int32_t kThiefCount{3};
+  static constexpr int32_t kPushCount{100000};
+  plain::WorkStealingDeque<int32_t> deque{8};
+  std::vector<std::atomic_int32_t> taken(kPushCount);
+  std::atomic_bool done{false};
+  std::vector<std::thread> thieves;
+  for (int32_t i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&deque, &taken, &done] {
+      while (!done.load() || !deque.empty()) {
+        if (auto value = deque.steal()) ++taken[*value];
+      }
+    });
+  }
+  // Each value taken only once by the owner or a thief.
+  for (int32_t i = 0; i < kPushCount; ++i) {
+    deque.push(i);
+    if (i % 3 == 0) {
+      if (auto value = deque.pop()) ++taken[*value];
+    }
+  }
+  while (auto value = deque.pop()) ++taken[*value];
+  done = true;
+  for (auto &thief : thieves) thief.join();
+  for (int32_t i = 0; i < kPushCount; ++i)
+    ASSERT_EQ(taken[i].load(), 1);
+}
+
+TEST_F(TWorkStealingDeque, testOrder) {
+  work_stealing_deque_order();
+}
+
+TEST_F(TWorkStealingDeque, testThieves) {
+  work_stealing_deque_thieves();
+}
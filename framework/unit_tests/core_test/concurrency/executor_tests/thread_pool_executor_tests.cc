@@ -40,6 +40,10 @@ void test_thread_pool_executor_bulk_submit();
 
 void test_thread_pool_executor_enqueue_algorithm();
 void test_thread_pool_executor_dynamic_resizing();
+void test_thread_pool_executor_steal();
+void test_thread_pool_executor_bench();
+void test_thread_pool_executor_wait_policy();
+void test_thread_pool_executor_bench_wake();
 
 void test_thread_pool_executor_thread_callbacks();
 
@@ -511,7 +515,15 @@ void plain::tests::test_thread_pool_executor_enqueue_algorithm() {
     observer.wait_execution_count(task_count, std::chrono::minutes(1));
     observer.wait_destruction_count(task_count, std::chrono::minutes(1));
 
-    ASSERT_EQ(observer.get_execution_map().size(), worker_count);
+    // The first waked one may steal all of the blocked ones' queues, so only
+    // check every task ran once on the pool workers(not every worker ran).
+    const auto execution_map = observer.get_execution_map();
+    ASSERT_GE(execution_map.size(), static_cast<size_t>(1));
+    ASSERT_LE(execution_map.size(), worker_count);
+    size_t execution_count{0};
+    for (const auto &[thread_id, invocation_count] : execution_map)
+      execution_count += invocation_count;
+    ASSERT_EQ(execution_count, task_count);
   }
 }
 
@@ -579,6 +591,170 @@ void plain::tests::test_thread_pool_executor_dynamic_resizing() {
   }
 }
 
+// The blocked worker's local tasks stolen by the idle one.
+void plain::tests::test_thread_pool_executor_steal() {
+  using namespace std::chrono_literals;
+  auto executor = std::make_shared<plain::concurrency::executor::ThreadPool>(
+    "threadpool", 2, std::chrono::seconds(10));
+  executor_shutdowner shutdown(executor);
+  std::atomic_int32_t count{0};
+  std::atomic_bool done{false};
+  std::atomic<size_t> parent_thread_id{0};
+  std::atomic<size_t> child_thread_id{0};
+  executor->post([&] {
+    parent_thread_id = plain::thread::get_current_virtual_id();
+    for (int32_t i = 0; i < 2; ++i) {
+      executor->post([&] {
+        child_thread_id = plain::thread::get_current_virtual_id();
+        ++count;
+      });
+    }
+    for (int32_t i = 0; i < 5000 && count < 2; ++i)
+      std::this_thread::sleep_for(1ms);
+    done = true;
+  });
+  for (int32_t i = 0; i < 10000 && !done; ++i)
+    std::this_thread::sleep_for(1ms);
+  ASSERT_TRUE(done);
+  ASSERT_EQ(count, 2);
+  ASSERT_NE(parent_thread_id, child_thread_id);
+}
+
+namespace plain::tests {
+
+static void fork_join(
+  plain::concurrency::executor::ThreadPool *executor, int32_t depth,
+  std::atomic_int64_t &leaves) {
+  if (depth == 0) {
+    leaves.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  executor->post([executor, depth, &leaves] {
+    fork_join(executor, depth - 1, leaves);
+  });
+  executor->post([executor, depth, &leaves] {
+    fork_join(executor, depth - 1, leaves);
+  });
+}
+
+}
+
+// The fork join tree and the long producer on a worker.
+void plain::tests::test_thread_pool_executor_bench() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kDepth{18};
+  static constexpr int64_t kLeafCount{1 << kDepth};
+  static constexpr int64_t kTaskCount{1000000};
+  const auto worker_count =
+    std::max<size_t>(4, std::thread::hardware_concurrency());
+  auto executor = std::make_shared<plain::concurrency::executor::ThreadPool>(
+    "threadpool", worker_count, std::chrono::seconds(10));
+  executor_shutdowner shutdown(executor);
+
+  std::atomic_int64_t leaves{0};
+  auto start = plain::Time::nanoseconds();
+  executor->post([executor = executor.get(), &leaves] {
+    fork_join(executor, kDepth, leaves);
+  });
+  while (leaves.load(std::memory_order_relaxed) < kLeafCount)
+    std::this_thread::sleep_for(1ms);
+  auto fork = plain::Time::nanoseconds() - start;
+
+  std::atomic_int64_t count{0};
+  start = plain::Time::nanoseconds();
+  executor->post([executor = executor.get(), &count] {
+    for (int64_t i = 0; i < kTaskCount; ++i) {
+      executor->post([&count] {
+        count.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+  });
+  while (count.load(std::memory_order_relaxed) < kTaskCount)
+    std::this_thread::sleep_for(1ms);
+  auto produce = plain::Time::nanoseconds() - start;
+  std::cout << "thread pool workers: " << worker_count << " "
+    << "fork join " << fork / (kLeafCount * 2 - 2) << "ns/task "
+    << "producer " << produce / kTaskCount << "ns/task" << std::endl;
+}
+
+void plain::tests::test_thread_pool_executor_wait_policy() {
+  using namespace std::chrono_literals;
+  using plain::concurrency::executor::detail::Parker;
+
+  // The timeout, the signal before park and the wake from the other thread.
+  Parker parker{plain::concurrency::kAdaptiveWaitPolicy};
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(parker.park_until(start + 20ms));
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 20ms);
+  parker.unpark();
+  parker.unpark();
+  ASSERT_TRUE(parker.park_until(std::chrono::steady_clock::now() + 1s));
+  ASSERT_FALSE(parker.park_until(std::chrono::steady_clock::now() + 1ms));
+  std::thread waker([&parker] {
+    std::this_thread::sleep_for(20ms);
+    parker.unpark();
+  });
+  ASSERT_TRUE(parker.park_until(std::chrono::steady_clock::now() + 10s));
+  waker.join();
+
+  auto executor = std::make_shared<plain::concurrency::executor::ThreadPool>(
+    "threadpool", 2, std::chrono::seconds(10), nullptr, nullptr,
+    plain::concurrency::kAdaptiveWaitPolicy);
+  executor_shutdowner shutdown(executor);
+  ASSERT_EQ(executor->wait_policy().spin_count,
+    plain::concurrency::kAdaptiveWaitPolicy.spin_count);
+  std::atomic_int32_t count{0};
+  for (int32_t i = 0; i < 100; ++i) {
+    executor->post([&count] { ++count; });
+    if (i % 10 == 0) std::this_thread::sleep_for(1ms);
+  }
+  for (int32_t i = 0; i < 5000 && count < 100; ++i)
+    std::this_thread::sleep_for(1ms);
+  ASSERT_EQ(count, 100);
+}
+
+// The post to the idle worker until the task run, the gap let it idle.
+void plain::tests::test_thread_pool_executor_bench_wake() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kSampleCount{5000};
+  auto bench = [](
+    std::string_view name, plain::concurrency::executor::Basic &executor) {
+    std::vector<int64_t> samples(kSampleCount);
+    std::atomic_int32_t done{0};
+    for (int32_t i = 0; i < kSampleCount; ++i) {
+      auto start = plain::Time::nanoseconds();
+      executor.post([&samples, &done, start, i] {
+        samples[i] = plain::Time::nanoseconds() - start;
+        done.store(i + 1, std::memory_order_release);
+      });
+      while (done.load(std::memory_order_acquire) <= i)
+        std::this_thread::yield();
+      std::this_thread::sleep_for(20us);
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double value) {
+      return samples[static_cast<size_t>(value * (kSampleCount - 1))] / 1000.0;
+    };
+    std::cout << name << " wake latency(us): "
+      << "p50 " << percentile(0.5) << " p99 " << percentile(0.99)
+      << " p999 " << percentile(0.999) << std::endl;
+  };
+  for (auto policy : {
+    plain::concurrency::wait_policy_t{},
+    plain::concurrency::kAdaptiveWaitPolicy}) {
+    std::string name{policy.spin_count == 0 ? "park" : "adaptive"};
+    auto thread_pool = std::make_shared<plain::concurrency::executor::ThreadPool>(
+      "threadpool", 1, std::chrono::seconds(10), nullptr, nullptr, policy);
+    executor_shutdowner thread_pool_shutdown(thread_pool);
+    bench("thread pool " + name, *thread_pool);
+    auto worker_thread =
+      std::make_shared<plain::concurrency::executor::WorkerThread>(
+        nullptr, nullptr, policy);
+    executor_shutdowner worker_thread_shutdown(worker_thread);
+    bench("worker thread " + name, *worker_thread);
+  }
+}
+
 void plain::tests::test_thread_pool_executor_thread_callbacks() {
   constexpr std::string_view thread_pool_name = "threadpool";
   test_thread_callbacks(
@@ -648,6 +824,22 @@ TEST_F(ThreadPoolExecutor, testDynamicResizing) {
   test_thread_pool_executor_dynamic_resizing();
 }
 
+TEST_F(ThreadPoolExecutor, testSteal) {
+  test_thread_pool_executor_steal();
+}
+
+TEST_F(ThreadPoolExecutor, testWaitPolicy) {
+  test_thread_pool_executor_wait_policy();
+}
+
+TEST_F(ThreadPoolExecutor, bench) {
+  test_thread_pool_executor_bench();
+}
+
+TEST_F(ThreadPoolExecutor, benchWake) {
+  test_thread_pool_executor_bench_wake();
+}
+
 TEST_F(ThreadPoolExecutor, testThreadCallbacks) {
   test_thread_pool_executor_thread_callbacks();
 }
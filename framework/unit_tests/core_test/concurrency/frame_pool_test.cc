@@ -0,0 +1,235 @@
+#include "gtest/gtest.h"
+#include <thread>
+#include "plain/all.h"
+#include "plain/concurrency/frame_pool.h"
+
+using namespace plain::concurrency;
+using plain::concurrency::detail::allocate_frame;
+using plain::concurrency::detail::deallocate_frame;
+using plain::concurrency::detail::kFramePoolMaxSize;
+
+class FramePool : public testing::Test {
+
+ public:
+   static void SetUpTestCase() {
+     //Normal.
+   }
+
+   static void TearDownTestCase() {
+     //std::cout << "TearDownTestCase" << std::endl;
+   }
+
+ public:
+
+   virtual void SetUp() {
+   }
+
+   virtual void TearDown() {
+   }
+
+};
+
+namespace plain::tests {
+
+void test_frame_pool_reuse();
+void test_frame_pool_remote();
+void test_frame_pool_coroutine();
+void test_frame_pool_bench();
+
+}
+
+void plain::tests::test_frame_pool_reuse() {
+  auto frame = allocate_frame(100);
+  deallocate_frame(frame, 100);
+  auto reused = allocate_frame(100);
+  ASSERT_EQ(frame, reused);
+  deallocate_frame(reused, 100);
+
+  // The bigger frames not pooled.
+  auto large = allocate_frame(kFramePoolMaxSize * 2);
+  ASSERT_NE(large, nullptr);
+  deallocate_frame(large, kFramePoolMaxSize * 2);
+}
+
+void plain::tests::test_frame_pool_remote() {
+  // The frame freed on the other thread return to the owner.
+  auto frame = allocate_frame(300);
+  std::thread([frame] { deallocate_frame(frame, 300); }).join();
+  auto reused = allocate_frame(300);
+  ASSERT_EQ(frame, reused);
+  deallocate_frame(reused, 300);
+
+  // The owner exited before its frames freed.
+  void *orphan{nullptr};
+  std::thread([&orphan] {
+    orphan = allocate_frame(300);
+    deallocate_frame(allocate_frame(300), 300);
+  }).join();
+  ASSERT_NE(orphan, nullptr);
+  deallocate_frame(orphan, 300);
+}
+
+namespace {
+
+Result<int32_t> frame_value(int32_t value) {
+  co_return value;
+}
+
+LazyResult<int32_t> frame_lazy_value(int32_t value) {
+  co_return value;
+}
+
+Result<int64_t> frame_lazy_sum(int32_t count) {
+  int64_t r{0};
+  for (int32_t i = 0; i < count; ++i)
+    r += co_await frame_lazy_value(i);
+  co_return r;
+}
+
+result::Generator<int32_t> frame_range(int32_t first, int32_t count) {
+  for (int32_t i = first; i < first + count; ++i)
+    co_yield i;
+}
+
+// The frames allocated on this thread and freed on the other one(the
+// executor resumed and destroyed pattern), return the ns per frame.
+template <typename A, typename F>
+int64_t bench_cross_thread(int32_t count, A &&allocate, F &&deallocate) {
+  static constexpr size_t kBatchSize{1024};
+  static constexpr size_t kBatchCount{16};
+  std::vector<std::vector<void *>> batches(
+    kBatchCount, std::vector<void *>(kBatchSize));
+  std::atomic_size_t produced{0};
+  std::atomic_size_t consumed{0};
+  const size_t total{count / kBatchSize};
+  auto start = plain::Time::nanoseconds();
+  std::thread consumer([&] {
+    for (size_t i = 0; i < total; ++i) {
+      while (produced.load(std::memory_order_acquire) <= i)
+        std::this_thread::yield();
+      for (auto frame : batches[i % kBatchCount])
+        deallocate(frame);
+      consumed.store(i + 1, std::memory_order_release);
+    }
+  });
+  for (size_t i = 0; i < total; ++i) {
+    while (i - consumed.load(std::memory_order_acquire) >= kBatchCount)
+      std::this_thread::yield();
+    for (auto &frame : batches[i % kBatchCount])
+      frame = allocate();
+    produced.store(i + 1, std::memory_order_release);
+  }
+  consumer.join();
+  return (plain::Time::nanoseconds() - start) /
+    static_cast<int64_t>(total * kBatchSize);
+}
+
+} // namespace
+
+void plain::tests::test_frame_pool_coroutine() {
+  auto executor = std::make_shared<executor::ThreadPool>(
+    "threadpool", 2, std::chrono::seconds(10));
+  static constexpr int32_t kCount{1000};
+  int64_t sum{0};
+  for (int32_t i = 0; i < kCount; ++i)
+    sum += frame_value(i).get();
+  ASSERT_EQ(sum, kCount * (kCount - 1) / 2);
+  ASSERT_EQ(frame_lazy_sum(kCount).get(), sum);
+  int64_t generated{0};
+  for (auto value : frame_range(0, kCount))
+    generated += value;
+  ASSERT_EQ(generated, sum);
+
+  // The frames created here and destroyed in the pool.
+  std::vector<Result<int32_t>> results;
+  for (int32_t i = 0; i < kCount; ++i)
+    results.emplace_back(executor->submit([i] { return i; }));
+  int64_t submitted{0};
+  for (auto &result : results)
+    submitted += result.get();
+  ASSERT_EQ(submitted, sum);
+  executor->shutdown();
+}
+
+// The short coroutines(frame allocate and free each) per second.
+void plain::tests::test_frame_pool_bench() {
+  static constexpr int32_t kCount{10000000};
+#ifdef PLAIN_CONCURRENCY_FRAME_POOL
+  std::cout << "coroutine frame pool: on" << std::endl;
+#else
+  std::cout << "coroutine frame pool: off" << std::endl;
+#endif
+  auto start = plain::Time::nanoseconds();
+  int64_t sum{0};
+  for (int32_t i = 0; i < kCount; ++i)
+    sum += frame_value(i).get();
+  auto end = plain::Time::nanoseconds();
+  ASSERT_EQ(sum, static_cast<int64_t>(kCount) * (kCount - 1) / 2);
+  std::cout << "result: " << (end - start) / kCount << "ns/coroutine"
+    << std::endl;
+
+  // Each run the lazy and the result coroutine(not await in a loop, the
+  // symmetric transfer may not the tail call in the debug builds).
+  start = plain::Time::nanoseconds();
+  int64_t lazy_sum{0};
+  for (int32_t i = 0; i < kCount; ++i)
+    lazy_sum += frame_lazy_value(i).run().get();
+  end = plain::Time::nanoseconds();
+  ASSERT_EQ(lazy_sum, sum);
+  std::cout << "lazy result: " << (end - start) / kCount << "ns/run"
+    << std::endl;
+
+  start = plain::Time::nanoseconds();
+  int64_t generated{0};
+  for (int32_t i = 0; i < kCount; ++i)
+    generated += *frame_range(i, 1).begin();
+  end = plain::Time::nanoseconds();
+  ASSERT_EQ(generated, sum);
+  std::cout << "generator: " << (end - start) / kCount << "ns/coroutine"
+    << std::endl;
+
+  start = plain::Time::nanoseconds();
+  for (int32_t i = 0; i < kCount; ++i) {
+    auto frame = allocate_frame(128);
+    deallocate_frame(frame, 128);
+  }
+  end = plain::Time::nanoseconds();
+  std::cout << "allocate frame: " << (end - start) * 1000 / kCount
+    << "ps/frame" << std::endl;
+
+  start = plain::Time::nanoseconds();
+  for (int32_t i = 0; i < kCount; ++i) {
+    auto frame = ::operator new(128);
+    ::operator delete(frame, 128);
+  }
+  end = plain::Time::nanoseconds();
+  std::cout << "operator new: " << (end - start) * 1000 / kCount
+    << "ps/frame" << std::endl;
+
+  std::cout << "cross thread allocate frame: " << bench_cross_thread(kCount,
+    [] { return allocate_frame(128); },
+    [](void *frame) { deallocate_frame(frame, 128); }) << "ns/frame"
+    << std::endl;
+  std::cout << "cross thread operator new: " << bench_cross_thread(kCount,
+    [] { return ::operator new(128); },
+    [](void *frame) { ::operator delete(frame, 128); }) << "ns/frame"
+    << std::endl;
+}
+
+using namespace plain::tests;
+
+TEST_F(FramePool, testReuse) {
+  test_frame_pool_reuse();
+}
+
+TEST_F(FramePool, testRemote) {
+  test_frame_pool_remote();
+}
+
+TEST_F(FramePool, testCoroutine) {
+  test_frame_pool_coroutine();
+}
+
+TEST_F(FramePool, bench) {
+  test_frame_pool_bench();
+}
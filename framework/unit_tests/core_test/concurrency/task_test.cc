@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include <array>
+#include "plain/all.h"
+#include "util/executor_shutdowner.h"
+
+using namespace plain::concurrency;
+using plain::concurrency::detail::task_constants;
+
+class ConcurrencyTask : public testing::Test {
+
+ public:
+   static void SetUpTestCase() {
+     //Normal.
+   }
+
+   static void TearDownTestCase() {
+     //std::cout << "TearDownTestCase" << std::endl;
+   }
+
+ public:
+
+   virtual void SetUp() {
+   }
+
+   virtual void TearDown() {
+   }
+
+};
+
+namespace plain::tests {
+
+void test_concurrency_task_counters();
+void test_concurrency_task_spilled();
+void test_concurrency_task_bench();
+
+}
+
+void plain::tests::test_concurrency_task_counters() {
+  ASSERT_EQ(sizeof(Task), task_constants::total_size);
+  std::array<char, task_constants::buffer_size * 2> large{};
+  auto before = task_counters();
+  int32_t count{0};
+  Task small_task([&count] { ++count; });
+  ASSERT_EQ(task_counters().inline_count, before.inline_count + 1);
+  ASSERT_EQ(task_counters().heap_count, before.heap_count);
+  small_task();
+  ASSERT_EQ(count, 1);
+
+  // The second spilled task of the same size reuse the freed one.
+  for (int32_t i = 0; i < 2; ++i) {
+    Task large_task([&count, large] { count += large.size() > 0 ? 1 : 0; });
+    large_task();
+  }
+  ASSERT_EQ(count, 3);
+  auto after = task_counters();
+  ASSERT_EQ(after.heap_count, before.heap_count + 2);
+  ASSERT_GE(after.pooled_count, before.pooled_count + 1);
+}
+
+void plain::tests::test_concurrency_task_spilled() {
+  std::array<char, task_constants::buffer_size * 4> large{};
+  auto value = std::make_shared<int32_t>(0);
+
+  // Release the captures when moved, cleared and the execute throw.
+  {
+    Task task([value, large] { *value += static_cast<int32_t>(large[0]); });
+    ASSERT_EQ(value.use_count(), 2);
+    Task moved(std::move(task));
+    ASSERT_FALSE(static_cast<bool>(task));
+    ASSERT_EQ(value.use_count(), 2);
+    moved.clear();
+    ASSERT_EQ(value.use_count(), 1);
+  }
+  Task task([value, large]() {
+    if (large[0] == 0) throw std::runtime_error("task");
+  });
+  ASSERT_EQ(value.use_count(), 2);
+  ASSERT_THROW(task(), std::runtime_error);
+  ASSERT_EQ(value.use_count(), 1);
+}
+
+namespace {
+
+template <typename F>
+void bench_post(
+  const std::string &name, executor::Basic &executor, int64_t task_count,
+  F &&drain) {
+  std::array<char, 96> large{};
+  for (auto spilled : {false, true}) {
+    std::atomic_int64_t count{0};
+    auto before = task_counters();
+    auto start = plain::Time::nanoseconds();
+    for (int64_t i = 0; i < task_count; ++i) {
+      if (spilled) {
+        executor.post([&count, large] {
+          count.fetch_add(large[0] + 1, std::memory_order_relaxed);
+        });
+      } else {
+        executor.post([&count] {
+          count.fetch_add(1, std::memory_order_relaxed);
+        });
+      }
+    }
+    auto posted = plain::Time::nanoseconds() - start;
+    drain(count, task_count);
+    auto end = plain::Time::nanoseconds() - start;
+    auto after = task_counters();
+    std::cout << name << (spilled ? " spilled: " : " inline: ")
+      << posted / task_count << "ns/post "
+      << end / task_count << "ns/task "
+      << "heap " << after.heap_count - before.heap_count << " "
+      << "pooled " << after.pooled_count - before.pooled_count << std::endl;
+  }
+}
+
+void wait_count(std::atomic_int64_t &count, int64_t task_count) {
+  using namespace std::chrono_literals;
+  while (count.load(std::memory_order_relaxed) < task_count)
+    std::this_thread::sleep_for(100us);
+}
+
+} // namespace
+
+// The post throughput of each executor with the inline and spilled callable.
+void plain::tests::test_concurrency_task_bench() {
+  static constexpr int64_t kTaskCount{200000};
+  std::cout << "task size: " << sizeof(Task) << std::endl;
+  {
+    auto executor = std::make_shared<executor::Inline>();
+    executor_shutdowner shutdown(executor);
+    bench_post("inline", *executor, kTaskCount, wait_count);
+  }
+  {
+    auto executor = std::make_shared<executor::Manual>();
+    executor_shutdowner shutdown(executor);
+    bench_post("manual", *executor, kTaskCount,
+      [&executor](std::atomic_int64_t &count, int64_t task_count) {
+        while (count.load(std::memory_order_relaxed) < task_count)
+          executor->loop(static_cast<size_t>(task_count));
+      });
+  }
+  {
+    auto executor = std::make_shared<executor::WorkerThread>();
+    executor_shutdowner shutdown(executor);
+    bench_post("worker thread", *executor, kTaskCount, wait_count);
+  }
+  {
+    auto executor = std::make_shared<executor::ThreadPool>(
+      "threadpool", 4, std::chrono::seconds(10));
+    executor_shutdowner shutdown(executor);
+    bench_post("thread pool", *executor, kTaskCount, wait_count);
+  }
+  {
+    auto executor = std::make_shared<executor::Thread>();
+    executor_shutdowner shutdown(executor);
+    bench_post("thread", *executor, kTaskCount / 100, wait_count);
+  }
+}
+
+using namespace plain::tests;
+
+TEST_F(ConcurrencyTask, testCounters) {
+  test_concurrency_task_counters();
+}
+
+TEST_F(ConcurrencyTask, testSpilled) {
+  test_concurrency_task_spilled();
+}
+
+TEST_F(ConcurrencyTask, bench) {
+  test_concurrency_task_bench();
+}
@@ -17,6 +17,8 @@ void test_timer_queue_make_delay_object();
 void test_timer_queue_max_worker_idle_time();
 void test_timer_queue_thread_injection();
 void test_timer_queue_thread_callbacks();
+void test_timer_queue_wheel();
+void test_timer_queue_bench();
 
 }  // namespace plain::tests
 
@@ -158,6 +160,102 @@ void plain::tests::test_timer_queue_thread_callbacks() {
   ASSERT_EQ(thread_terminated_callback_invocations_num, 1);
 }
 
+void plain::tests::test_timer_queue_wheel() {
+  auto timer_queue = std::make_shared<plain::TimerQueue>(
+    120s, nullptr, nullptr, plain::TimerQueueMode::Wheel, 1ms);
+  ASSERT_EQ(timer_queue->mode(), plain::TimerQueueMode::Wheel);
+  auto inline_executor = std::make_shared<plain::concurrency::executor::Inline>();
+  executor_shutdowner es(inline_executor);
+
+  // The 300ms one cascade from the second level(256 ticks).
+  std::atomic_int32_t fired10{0};
+  std::atomic_int32_t fired300{0};
+  std::atomic_int32_t fired_cancelled{0};
+  std::atomic_int32_t fired_periodic{0};
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<std::chrono::steady_clock::time_point> end300;
+  auto timer10 = timer_queue->make_one_shot_timer(
+    10ms, inline_executor, [&fired10] { ++fired10; });
+  auto timer300 = timer_queue->make_one_shot_timer(
+    300ms, inline_executor, [&fired300, &end300] {
+      end300 = std::chrono::steady_clock::now();
+      ++fired300;
+    });
+  auto cancelled = timer_queue->make_one_shot_timer(
+    50ms, inline_executor, [&fired_cancelled] { ++fired_cancelled; });
+  auto periodic = timer_queue->make_timer(
+    20ms, 20ms, inline_executor, [&fired_periodic] { ++fired_periodic; });
+  cancelled.cancel();
+  for (int32_t i = 0; i < 100 && fired300 == 0; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(fired10, 1);
+  ASSERT_EQ(fired300, 1);
+  ASSERT_EQ(fired_cancelled, 0);
+  ASSERT_GE(end300.load() - start, 300ms);
+  ASSERT_GE(fired_periodic, 5);
+  periodic.cancel();
+  auto count = fired_periodic.load();
+  std::this_thread::sleep_for(60ms);
+  ASSERT_EQ(fired_periodic, count);
+  timer_queue->shutdown();
+
+  // The coarse tick round the deadline up.
+  timer_queue = std::make_shared<plain::TimerQueue>(
+    120s, nullptr, nullptr, plain::TimerQueueMode::Wheel, 10ms);
+  std::atomic_int32_t fired{0};
+  start = std::chrono::steady_clock::now();
+  auto timer = timer_queue->make_one_shot_timer(
+    25ms, inline_executor, [&fired] { ++fired; });
+  for (int32_t i = 0; i < 100 && fired == 0; ++i)
+    std::this_thread::sleep_for(5ms);
+  ASSERT_EQ(fired, 1);
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 25ms);
+  timer_queue->shutdown();
+}
+
+// The multiset and the wheel with 1M timers.
+void plain::tests::test_timer_queue_bench() {
+  static constexpr int32_t kTimerCount{1000000};
+  auto inline_executor = std::make_shared<plain::concurrency::executor::Inline>();
+  executor_shutdowner es(inline_executor);
+  for (auto mode : {plain::TimerQueueMode::Set, plain::TimerQueueMode::Wheel}) {
+    auto timer_queue =
+      std::make_shared<plain::TimerQueue>(120s, nullptr, nullptr, mode, 1ms);
+    std::vector<plain::Timer> timers;
+    timers.reserve(kTimerCount);
+
+    // Add and cancel, the last marker fired after all requests processed.
+    std::atomic_bool done{false};
+    auto start = plain::Time::nanoseconds();
+    for (int32_t i = 0; i < kTimerCount; ++i) {
+      timers.emplace_back(timer_queue->make_one_shot_timer(
+        std::chrono::milliseconds(1000 + i % 60000), inline_executor, [] {}));
+    }
+    timers.clear();
+    auto marker = timer_queue->make_one_shot_timer(
+      0ms, inline_executor, [&done] { done = true; });
+    while (!done) std::this_thread::sleep_for(1ms);
+    auto add_cancel = plain::Time::nanoseconds() - start;
+
+    // Fire all in 100ms.
+    std::atomic_int32_t fired{0};
+    start = plain::Time::nanoseconds();
+    for (int32_t i = 0; i < kTimerCount; ++i) {
+      timers.emplace_back(timer_queue->make_one_shot_timer(
+        std::chrono::milliseconds(i % 100), inline_executor,
+        [&fired] { ++fired; }));
+    }
+    while (fired < kTimerCount) std::this_thread::sleep_for(1ms);
+    auto fire = plain::Time::nanoseconds() - start;
+    timers.clear();
+    timer_queue->shutdown();
+    std::cout << "timer queue "
+      << (mode == plain::TimerQueueMode::Set ? "set" : "wheel") << ": "
+      << "add+cancel " << add_cancel / kTimerCount << "ns/timer "
+      << "add+fire " << fire / kTimerCount << "ns/timer" << std::endl;
+  }
+}
+
 using namespace plain::tests;
 
 class TimerQueue : public testing::Test {
@@ -205,6 +303,14 @@ TEST_F(TimerQueue, testThreadCallbacks) {
   test_timer_queue_thread_callbacks();
 }
 
+TEST_F(TimerQueue, testWheel) {
+  test_timer_queue_wheel();
+}
+
+TEST_F(TimerQueue, bench) {
+  test_timer_queue_bench();
+}
+
 /*
 int main() {
   tester test("timer_queue test");
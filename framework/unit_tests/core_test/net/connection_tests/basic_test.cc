@@ -40,6 +40,15 @@ void test_net_connection_operator();
 void test_net_connection_funcs();
 void test_net_connection_send_line(
   connection::Basic *conn, std::string_view str);
+void test_net_connection_call_deadline();
+void test_net_connection_call_batch();
+void test_net_connection_call_bench();
+
+plain::concurrency::Result<int32_t>
+call_add(connection::Basic *conn, int32_t a, int32_t b) {
+  auto r = co_await conn->async_call("add", a, b);
+  co_return r.as<int32_t>();
+}
 
 }
 
@@ -78,6 +87,8 @@ void plain::tests::test_net_connection_funcs() {
   ASSERT_TRUE(r);
   r = conn.valid();
   ASSERT_FALSE(r);
+  r = conn.send(std::make_shared<packet::Basic>()); // The closed one.
+  ASSERT_FALSE(r);
   ASSERT_EQ(conn.id(), connection::kInvalidId);
   ASSERT_TRUE(conn.name().empty());
   ASSERT_TRUE(static_cast<bool>(conn.socket()));
@@ -189,6 +200,122 @@ void plain::tests::test_net_connection_funcs() {
   std::this_thread::sleep_for(50ms);
 }
 
+void plain::tests::test_net_connection_call_deadline() {
+  using namespace std::chrono_literals;
+  setting_t setting;
+  setting.address = ":9550";
+  setting.name = "deadline";
+  Listener listener(setting);
+  listener.bind("add", [](int32_t a, int32_t b) {
+    return a + b;
+  });
+  listener.bind("slow", []() {
+    std::this_thread::sleep_for(200ms);
+    return 1;
+  });
+  ASSERT_TRUE(listener.start());
+  setting_t connector_setting;
+  connector_setting.rpc_call_max_count = 2;
+  Connector connector(connector_setting);
+  ASSERT_TRUE(connector.start());
+  auto conn = connector.connect(":9550", nullptr, 5s);
+  ASSERT_TRUE(conn);
+
+  ASSERT_EQ(call_add(conn.get(), 1, 2).get(), 3);
+
+  // The timeout complete the result and the late response ignored.
+  conn->set_call_timeout(50ms);
+  auto start = std::chrono::steady_clock::now();
+  assert_throws_with_error_message<std::logic_error>(
+    [&conn] { conn->call("slow"); }, "call slow timeout: 50");
+  ASSERT_LT(std::chrono::steady_clock::now() - start, 190ms);
+
+  // The in flight calls bounded.
+  conn->clear_call_timeout();
+  auto r1 = conn->async_call("slow");
+  auto r2 = conn->async_call("slow");
+  auto r3 = conn->async_call("slow");
+  ASSERT_EQ(r3.status(), plain::concurrency::ResultStatus::Exception);
+  ASSERT_EQ(r1.get().as<int32_t>(), 1);
+  ASSERT_EQ(r2.get().as<int32_t>(), 1);
+  ASSERT_EQ(conn->call("add", 2, 3).as<int32_t>(), 5);
+
+  // The closed connection fail the calls.
+  auto r4 = conn->async_call("slow");
+  conn->close();
+  ASSERT_EQ(r4.status(), plain::concurrency::ResultStatus::Exception);
+}
+
+void plain::tests::test_net_connection_call_batch() {
+  using namespace std::chrono_literals;
+  setting_t setting;
+  setting.address = ":9551";
+  setting.name = "batch";
+  Listener listener(setting);
+  listener.bind("add", [](int32_t a, int32_t b) {
+    return a + b;
+  });
+  ASSERT_TRUE(listener.start());
+  setting_t connector_setting;
+  connector_setting.rpc_batch_count = 16;
+  Connector connector(connector_setting);
+  ASSERT_TRUE(connector.start());
+  auto conn = connector.connect(":9551", nullptr, 5s);
+  ASSERT_TRUE(conn);
+
+  // The corked calls flushed once(two batch frames).
+  std::vector<plain::concurrency::Result<rpc::Unpacker>> results;
+  conn->cork();
+  for (int32_t i = 0; i < 32; ++i)
+    results.emplace_back(conn->async_call("add", i, 1));
+  ASSERT_EQ(results[0].status(), plain::concurrency::ResultStatus::Idle);
+  conn->uncork();
+  for (int32_t i = 0; i < 32; ++i)
+    ASSERT_EQ(results[i].get().as<int32_t>(), i + 1);
+  ASSERT_EQ(conn->call("add", 2, 3).as<int32_t>(), 5);
+}
+
+// The calls per second with the outstanding calls.
+void plain::tests::test_net_connection_call_bench() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kCallCount{20000};
+  setting_t setting;
+  setting.address = ":9552";
+  setting.name = "call_bench";
+  setting.rpc_method_ids = true;
+  Listener listener(setting);
+  listener.bind("add", [](int32_t a, int32_t b) {
+    return a + b;
+  });
+  ASSERT_TRUE(listener.start());
+  for (uint32_t batch_count : {0, 64}) {
+    setting_t connector_setting;
+    connector_setting.rpc_batch_count = batch_count;
+    Connector connector(connector_setting);
+    ASSERT_TRUE(connector.start());
+    auto conn = connector.connect(":9552", nullptr, 5s);
+    ASSERT_TRUE(conn);
+    for (size_t outstanding : {1, 16, 256}) {
+      std::deque<plain::concurrency::Result<rpc::Unpacker>> results;
+      auto start = plain::Time::nanoseconds();
+      int64_t sum{0};
+      for (int32_t i = 0; i < kCallCount; ++i) {
+        if (results.size() >= outstanding) {
+          sum += results.front().get().as<int32_t>();
+          results.pop_front();
+        }
+        results.emplace_back(conn->async_call("add", i, 1));
+      }
+      for (auto &result : results) sum += result.get().as<int32_t>();
+      auto end = plain::Time::nanoseconds();
+      ASSERT_EQ(sum, static_cast<int64_t>(kCallCount) * (kCallCount + 1) / 2);
+      std::cout << "call batch: " << batch_count << " outstanding: "
+        << outstanding << " " << kCallCount * 1000000000LL / (end - start)
+        << " calls/s" << std::endl;
+    }
+  }
+}
+
 using namespace plain::tests;
 
 TEST_F(TConnection, testConstructor) {
@@ -202,3 +329,15 @@ TEST_F(TConnection, testOperator) {
 TEST_F(TConnection, testFunc) {
   test_net_connection_funcs();
 }
+
+TEST_F(TConnection, testCallDeadline) {
+  test_net_connection_call_deadline();
+}
+
+TEST_F(TConnection, testCallBatch) {
+  test_net_connection_call_batch();
+}
+
+TEST_F(TConnection, benchCall) {
+  test_net_connection_call_bench();
+}
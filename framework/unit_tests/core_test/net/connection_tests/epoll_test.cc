@@ -30,6 +30,7 @@ namespace plain::tests {
   void test_net_epoll_construct();
   void test_net_epoll_operator();
   void test_net_epoll_funcs();
+  void test_net_epoll_watermark();
 
 }
 
@@ -49,8 +50,70 @@ void plain::tests::test_net_epoll_funcs() {
 
 }
 
+// The slow peer(not read) over the high watermark, the output wait the
+// writable(the connection idle), then read all fall to the low watermark.
+void plain::tests::test_net_epoll_watermark() {
+  using namespace std::chrono_literals;
+  static std::atomic_int32_t high_count{0};
+  static std::atomic_int32_t low_count{0};
+  setting_t setting;
+  setting.mode = Mode::Epoll;
+  setting.address = "127.0.0.1:9546";
+  setting.name = "epoll1";
+  setting.output_high_watermark = 1024 * 1024;
+  setting.output_low_watermark = 64 * 1024;
+  Listener listener(setting);
+  listener.set_high_watermark_callback([](connection::Basic *) {
+    ++high_count;
+  });
+  listener.set_low_watermark_callback([](connection::Basic *) {
+    ++low_count;
+  });
+  ASSERT_TRUE(listener.start());
+  socket::Basic peer;
+  ASSERT_TRUE(peer.connect("127.0.0.1:9546"));
+  for (int32_t i = 0; i < 100 && listener.size() < 1; ++i)
+    std::this_thread::sleep_for(10ms);
+  auto conn = listener.get_conn(1);
+  ASSERT_TRUE(conn);
+  ASSERT_TRUE(conn->writable());
+  std::string str(4000, 'a');
+  for (int32_t i = 0; i < 4096; ++i) {
+    auto pack = conn->new_packet();
+    pack->set_id(1);
+    pack->set_writeable(true);
+    *pack << str;
+    pack->set_writeable(false);
+    conn->send(pack);
+  }
+  for (int32_t i = 0; i < 200 && high_count < 1; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(high_count, 1);
+  ASSERT_FALSE(conn->writable());
+  for (int32_t i = 0; i < 100 && !conn->idle(); ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_TRUE(conn->idle());
+  ASSERT_GT(conn->output_size(), 0);
+
+  ASSERT_TRUE(peer.set_nonblocking());
+  bytes_t bytes;
+  bytes.reserve(256 * 1024);
+  for (int32_t i = 0; i < 1000; ++i) {
+    if (low_count > 0 && conn->output_size() == 0) break;
+    if (peer.recv(bytes) <= 0) std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(low_count, 1);
+  ASSERT_EQ(high_count, 1);
+  ASSERT_TRUE(conn->writable());
+  ASSERT_EQ(conn->output_size(), 0);
+}
+
 using namespace plain::tests;
 
 TEST_F(TEpoll, testConstructor) {
   test_net_epoll_construct();
 }
+
+TEST_F(TEpoll, testWatermark) {
+  test_net_epoll_watermark();
+}
@@ -45,8 +45,83 @@ void plain::tests::test_net_io_uring_operator() {
 
 }
 
+// Echo with the listener in io uring mode(skip if disabled).
 void plain::tests::test_net_io_uring_funcs() {
-
+  using namespace std::chrono_literals;
+  static std::atomic_int32_t echoed{0};
+  setting_t setting;
+  setting.mode = Mode::IoUring;
+  setting.address = "127.0.0.1:9545";
+  setting.name = "io_uring1";
+  setting.send_zero_copy_size = 4096;
+  Listener listener(setting);
+  listener.set_handler(1, [](connection::Basic *conn, packet::Basic &packet) {
+    auto pack = conn->new_packet();
+    pack->set_id(packet.id());
+    pack->set_writeable(true);
+    pack->write(packet.data());
+    pack->set_writeable(false);
+    conn->send(pack);
+    return true;
+  });
+  if (!listener.start()) GTEST_SKIP() << "io uring disabled";
+  Connector connector;
+  connector.set_handler(1, [](connection::Basic *, packet::Basic &packet) {
+    std::string value;
+    packet >> value;
+    if (value == std::string(8192, 'a')) ++echoed;
+    return true;
+  });
+  ASSERT_TRUE(connector.start());
+  std::vector<std::shared_ptr<connection::Basic>> conns;
+  for (int32_t i = 0; i < 4; ++i) {
+    auto conn = connector.connect("127.0.0.1:9545");
+    ASSERT_TRUE(conn);
+    conns.emplace_back(conn);
+  }
+  // The packet larger than one ring buffer.
+  for (auto &conn : conns) {
+    auto pack = conn->new_packet();
+    pack->set_id(1);
+    pack->set_writeable(true);
+    *pack << std::string(8192, 'a');
+    conn->send(pack);
+  }
+  for (int32_t i = 0; i < 100 && echoed < 4; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(echoed, 4);
+  ASSERT_EQ(listener.size(), 4);
+  // The echo packets larger than the zero copy size.
+  auto stats = listener.stats();
+  ASSERT_GT(stats.send_zero_copy_size, 0);
+  ASSERT_LE(stats.send_zero_copy_size, stats.send_size);
+  conns[0]->close();
+  for (int32_t i = 0; i < 100 && listener.size() > 3; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 3);
+
+  // Removed with the zero copy sending, the reused one echo its own bytes.
+  for (auto &conn : conns) {
+    auto pack = conn->new_packet();
+    pack->set_id(1);
+    pack->set_writeable(true);
+    *pack << std::string(8192, 'b');
+    conn->send(pack);
+    conn->close();
+  }
+  for (int32_t i = 0; i < 100 && listener.size() > 0; ++i)
+    std::this_thread::sleep_for(10ms);
+  echoed = 0;
+  auto conn = connector.connect("127.0.0.1:9545");
+  ASSERT_TRUE(conn);
+  auto pack = conn->new_packet();
+  pack->set_id(1);
+  pack->set_writeable(true);
+  *pack << std::string(8192, 'a');
+  conn->send(pack);
+  for (int32_t i = 0; i < 100 && echoed < 1; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(echoed, 1);
 }
 
 using namespace plain::tests;
@@ -54,3 +129,7 @@ using namespace plain::tests;
 TEST_F(TIoUring, testConstructor) {
   test_net_io_uring_construct();
 }
+
+TEST_F(TIoUring, testFunc) {
+  test_net_io_uring_funcs();
+}
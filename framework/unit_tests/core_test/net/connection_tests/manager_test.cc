@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+#include "plain/all.h"
+#include "assertions.h"
+
+using namespace plain::net;
+
+class TManager : public testing::Test {
+
+ public:
+  static void SetUpTestCase() {
+    //Normal.
+  }
+
+  static void TearDownTestCase() {
+    //std::cout << "TearDownTestCase" << std::endl;
+  }
+
+ public:
+
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+
+};
+
+namespace plain::tests {
+
+void test_net_manager_conn();
+void test_net_manager_bench();
+void test_net_manager_idle();
+
+}
+
+void plain::tests::test_net_manager_conn() {
+  using namespace std::chrono_literals;
+  setting_t setting;
+  setting.address = "127.0.0.1:9533";
+  setting.name = "manager1";
+  setting.max_count = 4;
+  setting.default_count = 2;
+  Listener listener(setting);
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  ASSERT_TRUE(connector.start());
+  std::vector<std::shared_ptr<connection::Basic>> conns;
+  for (int32_t i = 0; i < 4; ++i) {
+    auto conn = connector.connect("127.0.0.1:9533");
+    ASSERT_TRUE(conn);
+    conns.emplace_back(conn);
+  }
+  for (int32_t i = 0; i < 100 && listener.size() < 4; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 4);
+  for (connection::id_t id = 1; id <= 4; ++id)
+    ASSERT_TRUE(listener.get_conn(id));
+  ASSERT_FALSE(listener.get_conn(5));
+
+  // The full listener refuse the new one and the removed id reused.
+  auto conn = connector.connect("127.0.0.1:9533");
+  std::this_thread::sleep_for(50ms);
+  ASSERT_EQ(listener.size(), 4);
+  conns[0]->close();
+  for (int32_t i = 0; i < 100 && listener.size() > 3; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 3);
+  conn = connector.connect("127.0.0.1:9533");
+  ASSERT_TRUE(conn);
+  for (int32_t i = 0; i < 100 && listener.size() < 4; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 4);
+}
+
+// The get_conn contention with threads.
+void plain::tests::test_net_manager_bench() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kConnCount{16};
+  static constexpr int32_t kGetCount{1000000};
+  setting_t setting;
+  setting.address = "127.0.0.1:9534";
+  setting.name = "manager2";
+  Listener listener(setting);
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  ASSERT_TRUE(connector.start());
+  for (int32_t i = 0; i < kConnCount; ++i)
+    ASSERT_TRUE(connector.connect("127.0.0.1:9534"));
+  for (int32_t i = 0; i < 100 && listener.size() < kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), kConnCount);
+  for (int32_t thread_count : {1, 2, 4, 8}) {
+    std::atomic_int64_t found{0};
+    std::vector<std::thread> threads;
+    auto start = plain::Time::nanoseconds();
+    for (int32_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&listener, &found] {
+        int64_t count{0};
+        for (int32_t j = 0; j < kGetCount; ++j) {
+          if (listener.get_conn(j % kConnCount + 1)) ++count;
+        }
+        found += count;
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    auto end = plain::Time::nanoseconds();
+    ASSERT_EQ(found, static_cast<int64_t>(thread_count) * kGetCount);
+    auto total = static_cast<int64_t>(thread_count) * kGetCount;
+    std::cout << "get_conn threads: " << thread_count << " "
+      << (end - start) / kGetCount << "ns(wall per thread op) "
+      << total * 1000 / (end - start) << "ops/us" << std::endl;
+  }
+}
+
+void plain::tests::test_net_manager_idle() {
+  using namespace std::chrono_literals;
+  setting_t setting;
+  setting.address = "127.0.0.1:9549";
+  setting.name = "manager3";
+  setting.read_idle_timeout = 100;
+  Listener listener(setting);
+  ASSERT_TRUE(listener.start());
+
+  // The silent one removed and the heartbeat one keep.
+  Connector connector;
+  ASSERT_TRUE(connector.start());
+  setting_t heartbeat_setting;
+  heartbeat_setting.name = "heartbeat";
+  heartbeat_setting.heartbeat_interval = 30;
+  Connector heartbeat_connector(heartbeat_setting);
+  ASSERT_TRUE(heartbeat_connector.start());
+  auto conn = connector.connect("127.0.0.1:9549");
+  ASSERT_TRUE(conn);
+  auto heartbeat_conn = heartbeat_connector.connect("127.0.0.1:9549");
+  ASSERT_TRUE(heartbeat_conn);
+  for (int32_t i = 0; i < 100 && listener.size() < 2; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 2);
+  std::this_thread::sleep_for(50ms);
+  ASSERT_EQ(listener.size(), 2); // Not early.
+  for (int32_t i = 0; i < 100 && listener.size() > 1; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), 1);
+  std::this_thread::sleep_for(300ms);
+  ASSERT_EQ(listener.size(), 1);
+  ASSERT_TRUE(heartbeat_conn->valid());
+}
+
+using namespace plain::tests;
+
+TEST_F(TManager, testConn) {
+  test_net_manager_conn();
+}
+
+TEST_F(TManager, testIdle) {
+  test_net_manager_idle();
+}
+
+TEST_F(TManager, bench) {
+  test_net_manager_bench();
+}
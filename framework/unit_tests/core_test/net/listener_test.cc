@@ -30,6 +30,11 @@ namespace plain::tests {
 void test_net_listener_constructor();
 void test_net_listener_operator();
 void test_net_listener_func();
+void test_net_listener_handler();
+void test_net_listener_reactor();
+void test_net_listener_bench();
+void test_net_listener_broadcast();
+void test_net_listener_broadcast_bench();
 
 error_or_t<std::shared_ptr<packet::Basic>>
 line_decode(stream::Basic *input, const packet::limit_t &packet_limit);
@@ -283,6 +288,274 @@ void plain::tests::test_net_listener_func() {
   std::this_thread::sleep_for(100ms);
 }
 
+void plain::tests::test_net_listener_handler() {
+  using namespace std::chrono_literals;
+  static std::atomic_int32_t handled{0};
+  static std::atomic_int32_t dispatched{0};
+  setting_t setting;
+  setting.address = "127.0.0.1:9532";
+  setting.name = "listener7";
+  Listener listener(setting);
+  listener.set_handler(2, [](connection::Basic *, packet::Basic &packet) {
+    std::string value;
+    packet >> value;
+    if (value == "hello") ++handled;
+    return true;
+  });
+  listener.set_dispatcher([](
+    connection::Basic *, std::shared_ptr<packet::Basic> packet) {
+    if (packet->id() == 3) ++dispatched;
+    return true;
+  });
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  ASSERT_TRUE(connector.start());
+  auto conn = connector.connect("127.0.0.1:9532");
+  ASSERT_TRUE(conn);
+  for (packet::id_t id : {2, 3, 2}) {
+    auto pack = conn->new_packet();
+    pack->set_id(id);
+    pack->set_writeable(true);
+    *pack << std::string{"hello"};
+    conn->send(pack);
+  }
+  for (int32_t i = 0; i < 100 && handled + dispatched < 3; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(handled, 2);
+  ASSERT_EQ(dispatched, 1);
+
+  auto stats = listener.stats();
+  ASSERT_EQ(stats.conn_count, 1);
+  ASSERT_EQ(stats.recv_packet_count, 3);
+  ASSERT_EQ(stats.decode_error_count, 0);
+  ASSERT_GT(stats.recv_size, 0);
+  ASSERT_EQ(connector.stats().send_packet_count, 3);
+  ASSERT_EQ(connector.stats().send_queue_size, 0);
+  auto conn_stats = connector.conn_stats();
+  ASSERT_EQ(conn_stats.size(), 1);
+  ASSERT_EQ(conn_stats[0].id, conn->id());
+  ASSERT_EQ(conn_stats[0].send_queue_size, 0);
+  ASSERT_EQ(listener.conn_stats().size(), 1);
+}
+
+// Echo the packet back(the pingpong).
+static bool listener_echo(connection::Basic *conn, packet::Basic &packet) {
+  auto pack = conn->new_packet();
+  pack->set_id(packet.id());
+  pack->set_writeable(true);
+  pack->write(packet.data());
+  pack->set_writeable(false);
+  conn->send(pack);
+  return true;
+}
+
+void plain::tests::test_net_listener_reactor() {
+  using namespace std::chrono_literals;
+  static std::atomic_int32_t echoed{0};
+  setting_t setting;
+  setting.address = "127.0.0.1:9535";
+  setting.name = "listener8";
+  // The kernel hashes the connections to the reactors, each one can hold all.
+  setting.max_count = 32;
+  setting.reactor_count = 4;
+  Listener listener(setting);
+  listener.set_handler(1, listener_echo);
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  connector.set_handler(1, [](connection::Basic *, packet::Basic &) {
+    ++echoed;
+    return true;
+  });
+  ASSERT_TRUE(connector.start());
+  static constexpr int32_t kConnCount{8};
+  std::vector<std::shared_ptr<connection::Basic>> conns;
+  for (int32_t i = 0; i < kConnCount; ++i) {
+    auto conn = connector.connect("127.0.0.1:9535");
+    ASSERT_TRUE(conn);
+    conns.emplace_back(conn);
+  }
+  for (int32_t i = 0; i < 100 && listener.size() < kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), kConnCount);
+  for (auto &conn : conns) {
+    auto pack = conn->new_packet();
+    pack->set_id(1);
+    pack->set_writeable(true);
+    *pack << std::string{"ping"};
+    conn->send(pack);
+  }
+  for (int32_t i = 0; i < 100 && echoed < kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(echoed, kConnCount);
+
+  // The reactor ids are not overlapped(each reactor have 8 ids).
+  int32_t found{0};
+  for (connection::id_t id = 1; id <= 32; ++id) {
+    auto conn = listener.get_conn(id);
+    if (conn && conn->valid()) {
+      ASSERT_EQ(conn->id(), id);
+      ++found;
+    }
+  }
+  ASSERT_EQ(found, kConnCount);
+  ASSERT_FALSE(listener.get_conn(33));
+  ASSERT_EQ(listener.stats().recv_packet_count, kConnCount);
+}
+
+// The pingpong throughput with the reactor count.
+void plain::tests::test_net_listener_bench() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kConnCount{16};
+  static constexpr auto kDuration{500ms};
+  static std::atomic_int64_t round_trips{0};
+  static std::atomic_bool running{false};
+  uint16_t port{9536};
+  for (uint32_t reactor_count : {1, 2, 4, 8}) {
+    setting_t setting;
+    setting.address = "127.0.0.1:" + std::to_string(port++);
+    setting.name = "listener_bench" + std::to_string(reactor_count);
+    setting.reactor_count = reactor_count;
+    Listener listener(setting);
+    listener.set_handler(1, listener_echo);
+    ASSERT_TRUE(listener.start());
+    Connector connector;
+    connector.set_handler(1, [](connection::Basic *conn, packet::Basic &p) {
+      ++round_trips;
+      return running ? listener_echo(conn, p) : true;
+    });
+    ASSERT_TRUE(connector.start());
+    std::vector<std::shared_ptr<connection::Basic>> conns;
+    for (int32_t i = 0; i < kConnCount; ++i) {
+      auto conn = connector.connect(setting.address);
+      ASSERT_TRUE(conn);
+      conns.emplace_back(conn);
+    }
+    round_trips = 0;
+    running = true;
+    std::string payload(64, 'a');
+    auto start = plain::Time::nanoseconds();
+    for (auto &conn : conns) {
+      auto pack = conn->new_packet();
+      pack->set_id(1);
+      pack->set_writeable(true);
+      *pack << payload;
+      conn->send(pack);
+    }
+    std::this_thread::sleep_for(kDuration);
+    running = false;
+    auto end = plain::Time::nanoseconds();
+    int64_t count = round_trips;
+    std::cout << "pingpong reactors: " << reactor_count << " conns: "
+      << kConnCount << " " << count * 1000000000 / (end - start)
+      << " round trips/s" << std::endl;
+    ASSERT_GT(count, 0);
+    connector.stop();
+    listener.stop();
+  }
+}
+
+// The full and the subset broadcast with one encode.
+void plain::tests::test_net_listener_broadcast() {
+  using namespace std::chrono_literals;
+  static std::atomic_int32_t received{0};
+  static constexpr int32_t kConnCount{4};
+  setting_t setting;
+  setting.address = "127.0.0.1:9547";
+  setting.name = "listener9";
+  Listener listener(setting);
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  connector.set_handler(2, [](connection::Basic *, packet::Basic &p) {
+    std::string str;
+    p >> str;
+    if (str == "hello") ++received;
+    return true;
+  });
+  ASSERT_TRUE(connector.start());
+  std::vector<std::shared_ptr<connection::Basic>> conns;
+  for (int32_t i = 0; i < kConnCount; ++i)
+    conns.emplace_back(connector.connect("127.0.0.1:9547"));
+  for (int32_t i = 0; i < 100 && listener.size() < kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), kConnCount);
+  auto pack = std::make_shared<packet::Basic>();
+  pack->set_id(2);
+  pack->set_writeable(true);
+  *pack << std::string{"hello"};
+  pack->set_writeable(false);
+
+  // The invalid ids skipped.
+  std::vector<connection::id_t> ids{1, 3, 100};
+  listener.broadcast(pack, ids);
+  for (int32_t i = 0; i < 100 && received < 2; ++i)
+    std::this_thread::sleep_for(10ms);
+  std::this_thread::sleep_for(20ms);
+  ASSERT_EQ(received, 2);
+  listener.broadcast(pack);
+  for (int32_t i = 0; i < 100 && received < 2 + kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(received, 2 + kConnCount);
+  ASSERT_EQ(listener.stats().send_packet_count, 2 + kConnCount);
+}
+
+// The fan-out cost per recipient, the send loop encode for each connection
+// and the broadcast encode once.
+void plain::tests::test_net_listener_broadcast_bench() {
+  using namespace std::chrono_literals;
+  static constexpr int32_t kConnCount{256};
+  static constexpr int32_t kRoundCount{50};
+  static std::atomic_int64_t received{0};
+  setting_t setting;
+  setting.address = "127.0.0.1:9548";
+  setting.name = "listener_bench_broadcast";
+  Listener listener(setting);
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  connector.set_handler(2, [](connection::Basic *, packet::Basic &) {
+    ++received;
+    return true;
+  });
+  ASSERT_TRUE(connector.start());
+  for (int32_t i = 0; i < kConnCount; ++i)
+    ASSERT_TRUE(connector.connect("127.0.0.1:9548"));
+  for (int32_t i = 0; i < 200 && listener.size() < kConnCount; ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(listener.size(), kConnCount);
+  for (size_t size : {256, 4096})
+  for (bool shared : {false, true}) {
+    std::string payload(size, 'a');
+    received = 0;
+    int64_t call_time{0};
+    auto start = plain::Time::nanoseconds();
+    for (int32_t i = 0; i < kRoundCount; ++i) {
+      auto pack = std::make_shared<packet::Basic>();
+      pack->set_id(2);
+      pack->set_writeable(true);
+      *pack << payload;
+      pack->set_writeable(false);
+      auto call_start = plain::Time::nanoseconds();
+      if (shared) {
+        listener.broadcast(pack);
+      } else {
+        for (connection::id_t id = 1; id <= kConnCount; ++id) {
+          auto conn = listener.get_conn(id);
+          if (conn) conn->send(pack);
+        }
+      }
+      call_time += plain::Time::nanoseconds() - call_start;
+    }
+    int64_t total = static_cast<int64_t>(kConnCount) * kRoundCount;
+    for (int32_t i = 0; i < 1000 && received < total; ++i)
+      std::this_thread::sleep_for(10ms);
+    auto end = plain::Time::nanoseconds();
+    ASSERT_EQ(received, total);
+    std::cout << (shared ? "broadcast" : "send loop") << " conns: "
+      << kConnCount << " payload: " << size << " call " << call_time / total << "ns "
+      << "delivered " << (end - start) / total << "ns(per recipient)"
+      << std::endl;
+  }
+}
+
 using namespace plain::tests;
 
 TEST_F(TListener, testConstructor) {
@@ -292,3 +565,23 @@ TEST_F(TListener, testConstructor) {
 TEST_F(TListener, testFunc) {
   test_net_listener_func();
 }
+
+TEST_F(TListener, testHandler) {
+  test_net_listener_handler();
+}
+
+TEST_F(TListener, testReactor) {
+  test_net_listener_reactor();
+}
+
+TEST_F(TListener, bench) {
+  test_net_listener_bench();
+}
+
+TEST_F(TListener, testBroadcast) {
+  test_net_listener_broadcast();
+}
+
+TEST_F(TListener, benchBroadcast) {
+  test_net_listener_broadcast_bench();
+}
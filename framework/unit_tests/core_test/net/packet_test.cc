@@ -30,6 +30,7 @@ namespace plain::tests {
 void test_net_packet_constructor();
 void test_net_packet_operator();
 void test_net_packet_func();
+void test_net_packet_pool();
 
 }
 
@@ -111,6 +112,45 @@ void plain::tests::test_net_packet_func() {
 
 }
 
+void plain::tests::test_net_packet_pool() {
+  packet::Pool pool{2};
+  auto p = pool.make();
+  ASSERT_EQ(pool.misses(), 1);
+  ASSERT_EQ(pool.hits(), 0);
+  p->set_id(1);
+  p->set_writeable(true);
+  *p << "hello world";
+  auto capacity = p->capacity();
+  auto pointer = p.get();
+  p.reset();
+  ASSERT_EQ(pool.size(), 1);
+
+  // The recycled one is clean and keep the data capacity.
+  p = pool.make();
+  ASSERT_EQ(pool.hits(), 1);
+  ASSERT_EQ(p.get(), pointer);
+  ASSERT_EQ(p->id(), 0);
+  ASSERT_TRUE(p->data().empty());
+  ASSERT_EQ(p->capacity(), capacity);
+  std::string str;
+  *p >> str;
+  ASSERT_TRUE(str.empty());
+
+  // The idle packets not more than the pool max size.
+  auto p1 = pool.make();
+  auto p2 = pool.make();
+  ASSERT_EQ(pool.misses(), 3);
+  p.reset();
+  p1.reset();
+  p2.reset();
+  ASSERT_EQ(pool.size(), 2);
+
+  // The packets can live longer than the pool.
+  auto p3 = std::make_unique<packet::Pool>()->make();
+  p3->set_writeable(true);
+  *p3 << 1;
+}
+
 using namespace plain::tests;
 
 TEST_F(TPacket, testConstructor) {
@@ -120,3 +160,7 @@ TEST_F(TPacket, testConstructor) {
 TEST_F(TPacket, testFunc) {
   test_net_packet_func();
 }
+
+TEST_F(TPacket, testPool) {
+  test_net_packet_pool();
+}
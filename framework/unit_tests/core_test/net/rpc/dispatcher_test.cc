@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "plain/all.h"
+#include "assertions.h"
+
+using namespace plain::net;
+
+class RpcDispatcher : public testing::Test {
+
+ public:
+  static void SetUpTestCase() {
+    //Normal.
+  }
+
+  static void TearDownTestCase() {
+    //std::cout << "TearDownTestCase" << std::endl;
+  }
+
+ public:
+
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+
+};
+
+namespace plain::tests {
+
+void test_net_rpc_dispatcher_method_id();
+void test_net_rpc_dispatcher_call();
+
+}
+
+void plain::tests::test_net_rpc_dispatcher_method_id() {
+  rpc::Dispatcher dispatcher;
+  dispatcher.bind("add", [](int32_t a, int32_t b) { return a + b; });
+  dispatcher.bind("sub", [](int32_t a, int32_t b) { return a - b; });
+  ASSERT_EQ(dispatcher.method_id("add"), 1);
+  ASSERT_EQ(dispatcher.method_id("sub"), 2);
+  ASSERT_EQ(dispatcher.method_id("none"), 0);
+  ASSERT_EQ(dispatcher.methods().size(), 2);
+
+  auto make_request = [](auto method) {
+    auto packet = std::make_shared<packet::Basic>();
+    packet->set_writeable(true);
+    if constexpr (std::is_same_v<decltype(method), rpc::method_id_t>) {
+      *packet << uint32_t{0};
+    }
+    *packet << method;
+    rpc::Packer packer;
+    auto args = std::make_tuple(7, 3);
+    packer.process(args);
+    *packet << packer.vector();
+    packet->set_writeable(false);
+    packet->set_readable(true);
+    return packet;
+  };
+  auto unpack = [](auto r) {
+    auto packer = std::get<std::shared_ptr<rpc::Packer>>(r);
+    rpc::Unpacker unpacker(packer->vector().data(), packer->vector().size());
+    return unpacker.as<int32_t>();
+  };
+  // The name and the id dispatch the same.
+  ASSERT_EQ(unpack(dispatcher.dispatch(make_request(std::string{"sub"}))), 4);
+  ASSERT_EQ(unpack(dispatcher.dispatch(make_request(rpc::method_id_t{2}))), 4);
+  ASSERT_EQ(unpack(dispatcher.dispatch(make_request(rpc::method_id_t{1}))), 10);
+
+  // The unbind id not reused.
+  dispatcher.unbind("add");
+  auto r = dispatcher.dispatch(make_request(rpc::method_id_t{1}));
+  ASSERT_TRUE(plain::get_error(r));
+  r = dispatcher.dispatch(make_request(rpc::method_id_t{9}));
+  ASSERT_TRUE(plain::get_error(r));
+  dispatcher.bind("add", [](int32_t a, int32_t b) { return a + b; });
+  ASSERT_EQ(dispatcher.method_id("add"), 3);
+}
+
+void plain::tests::test_net_rpc_dispatcher_call() {
+  using namespace std::chrono_literals;
+  setting_t setting;
+  setting.address = ":9553";
+  setting.name = "dispatcher";
+  setting.rpc_method_ids = true;
+  Listener listener(setting);
+  listener.bind("add", [](int32_t a, int32_t b) {
+    return a + b;
+  });
+  ASSERT_TRUE(listener.start());
+  Connector connector;
+  ASSERT_TRUE(connector.start());
+  auto conn = connector.connect(":9553", nullptr, 5s);
+  ASSERT_TRUE(conn);
+  std::this_thread::sleep_for(20ms); // The table received.
+  ASSERT_EQ(conn->call("add", 1, 2).as<int32_t>(), 3);
+
+  // Not in the table call with the name.
+  listener.bind("mul", [](int32_t a, int32_t b) {
+    return a * b;
+  });
+  ASSERT_EQ(conn->call("mul", 2, 3).as<int32_t>(), 6);
+  ASSERT_EQ(conn->call("add", 2, 3).as<int32_t>(), 5);
+}
+
+using namespace plain::tests;
+
+TEST_F(RpcDispatcher, testMethodId) {
+  test_net_rpc_dispatcher_method_id();
+}
+
+TEST_F(RpcDispatcher, testCall) {
+  test_net_rpc_dispatcher_call();
+}
@@ -99,7 +99,28 @@ void plain::tests::test_net_rpc_unpacker_construct() {
 }
 
 void plain::tests::test_net_rpc_unpacker_operator() {
-
+  auto packer = rpc::Packer{};
+  uint32_t value{12345};
+  packer.process(value);
+  packer.process(value + 1);
+  rpc::Unpacker unpacker(packer.vector().data(), packer.vector().size());
+  static_assert(std::is_copy_constructible_v<rpc::Unpacker>);
+  static_assert(std::is_copy_assignable_v<rpc::Unpacker>);
+
+  // The copy read from the same position on its own.
+  auto copied = unpacker;
+  uint32_t x{0};
+  unpacker.process(x);
+  ASSERT_EQ(x, value);
+  x = 0;
+  copied.process(x);
+  ASSERT_EQ(x, value);
+  copied = unpacker;
+  x = 0;
+  copied.process(x);
+  ASSERT_EQ(x, value + 1);
+  auto moved = std::move(copied);
+  ASSERT_FALSE(moved.error_);
 }
 
 void plain::tests::test_net_rpc_unpacker_funcs() {
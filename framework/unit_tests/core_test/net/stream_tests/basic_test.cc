@@ -30,6 +30,9 @@ namespace plain::tests {
   void test_net_stream_construct();
   void test_net_stream_operator();
   void test_net_stream_funcs();
+  void test_net_stream_pull();
+  void test_net_stream_push();
+  void test_net_stream_push_await();
 
 }
 
@@ -74,6 +77,201 @@ void plain::tests::test_net_stream_funcs() {
   std::array<std::byte, 32> array;
   r_size = stream.read(array.data(), 11);
   ASSERT_EQ(r_size, 11);
+
+  // The contiguous borrowed in place, the writing moves the buffer if it
+  // still borrowed and the released buffer reused.
+  std::string slice(4096, 's');
+  std::shared_ptr<const bytes_t> owner;
+  size_t copied{0};
+  ASSERT_EQ(stream.write(slice), slice.size());
+  auto data = stream.read_slice(slice.size(), owner, &copied);
+  ASSERT_EQ(copied, 0);
+  ASSERT_EQ(data.size(), slice.size());
+  auto first = data.data();
+  ASSERT_EQ(stream.write(std::string(slice.size(), 't')), slice.size());
+  ASSERT_EQ(data[0], std::byte{'s'}); // Not overwritten.
+  std::shared_ptr<const bytes_t> second;
+  ASSERT_NE(stream.read_slice(slice.size(), second, &copied).data(), first);
+  ASSERT_EQ(copied, 0);
+  owner.reset();
+  ASSERT_EQ(stream.write(slice), slice.size());
+  // The released one reused.
+  ASSERT_EQ(stream.read_slice(slice.size(), owner, &copied).data(), first);
+
+  // The wrapped copied(the default buffer size is 128).
+  auto wrapped = stream::Basic{sock};
+  ASSERT_EQ(wrapped.write(std::string(100, 'a')), 100);
+  ASSERT_EQ(wrapped.remove(90), 90);
+  ASSERT_EQ(wrapped.write(std::string(40, 'b')), 40);
+  ASSERT_EQ(wrapped.remove(10), 10);
+  data = wrapped.read_slice(40, owner, &copied);
+  ASSERT_EQ(copied, 40);
+  ASSERT_EQ(data.size(), 40);
+  ASSERT_EQ(data[39], std::byte{'b'});
+}
+
+void plain::tests::test_net_stream_pull() {
+  socket::id_t fds[2]{socket::kInvalidId, socket::kInvalidId};
+#if OS_WIN
+  auto family = AF_INET;
+#else
+  auto family = AF_UNIX;
+#endif
+  ASSERT_EQ(socket::socketpair(family, SOCK_STREAM, 0, fds), 0);
+  auto sock = std::make_shared<socket::Basic>(fds[0]);
+  socket::Basic peer{fds[1]};
+  auto stream = stream::Basic{sock};
+
+  // Let the ring free space wraps(the default buffer size is 128).
+  std::string str(100, 'a');
+  ASSERT_EQ(stream.write(str), 100);
+  str.resize(90);
+  ASSERT_EQ(stream.read(str), 90);
+
+  bytes_t bytes;
+  for (size_t i = 0; i < 60; ++i)
+    bytes.push_back(static_cast<std::byte>('0' + i % 10));
+  ASSERT_EQ(peer.send(bytes), 60);
+  ASSERT_EQ(stream.pull(), 60);
+  ASSERT_EQ(stream.size(), 70);
+  str.resize(10);
+  stream.read(str);
+  ASSERT_EQ(str, std::string(10, 'a'));
+  bytes_t r_bytes;
+  r_bytes.resize(60);
+  ASSERT_EQ(stream.read(r_bytes), 60);
+  ASSERT_EQ(r_bytes, bytes);
+
+  // More than the buffer size will grow it.
+  bytes.clear();
+  for (size_t i = 0; i < 1000; ++i)
+    bytes.push_back(static_cast<std::byte>(i % 256));
+  ASSERT_EQ(peer.send(bytes), 1000);
+  ASSERT_EQ(stream.pull(), 1000);
+  r_bytes.resize(1000);
+  ASSERT_EQ(stream.read(r_bytes), 1000);
+  ASSERT_EQ(r_bytes, bytes);
+  ASSERT_TRUE(stream.empty());
+
+  // The budget used up not drained, then read until would block.
+  ASSERT_TRUE(sock->set_nonblocking());
+  bytes.assign(10000, std::byte{1});
+  ASSERT_EQ(peer.send(bytes), 10000);
+  ASSERT_EQ(stream.pull(4096), 4096);
+  ASSERT_FALSE(stream.drained());
+  ASSERT_EQ(stream.pull(), 10000 - 4096);
+  ASSERT_TRUE(stream.drained());
+  ASSERT_EQ(stream.pull(), 0);
+  ASSERT_TRUE(stream.drained());
+  ASSERT_EQ(stream.size(), 10000);
+}
+
+void plain::tests::test_net_stream_push() {
+  socket::id_t fds[2]{socket::kInvalidId, socket::kInvalidId};
+#if OS_WIN
+  auto family = AF_INET;
+#else
+  auto family = AF_UNIX;
+#endif
+  ASSERT_EQ(socket::socketpair(family, SOCK_STREAM, 0, fds), 0);
+  auto sock = std::make_shared<socket::Basic>(fds[0]);
+  socket::Basic peer{fds[1]};
+  auto stream = stream::Basic{sock};
+
+  // The readable data wraps(the default buffer size is 128).
+  std::string str(100, 'a');
+  ASSERT_EQ(stream.write(str), 100);
+  str.resize(90);
+  ASSERT_EQ(stream.read(str), 90);
+  str = std::string(100, 'b');
+  ASSERT_EQ(stream.write(str), 100);
+
+  ASSERT_EQ(stream.push(), 110);
+  ASSERT_TRUE(stream.empty());
+  bytes_t bytes;
+  bytes.reserve(256);
+  ASSERT_EQ(peer.recv(bytes), 110);
+  std::string_view r{reinterpret_cast<const char *>(bytes.data()), 110};
+  ASSERT_EQ(r, std::string(10, 'a') + std::string(100, 'b'));
+
+  // The shared bytes gathered in order with the buffer(the small copied).
+  auto to_shared = [](std::string_view str) {
+    auto bytes = std::make_shared<bytes_t>();
+    bytes->resize(str.size());
+    memcpy(bytes->data(), str.data(), str.size());
+    return std::shared_ptr<const bytes_t>{bytes};
+  };
+  std::string shared1(2000, '1');
+  std::string shared2(3000, '2');
+  ASSERT_EQ(stream.write(std::string(10, 'x')), 10);
+  ASSERT_TRUE(stream.write(to_shared(shared1)));
+  ASSERT_EQ(stream.write(std::string(5, 'y')), 5);
+  ASSERT_TRUE(stream.write(to_shared(shared2)));
+  ASSERT_TRUE(stream.write(to_shared("small")));
+  ASSERT_FALSE(stream.write(to_shared("")));
+  ASSERT_EQ(stream.size(), 5020);
+  ASSERT_EQ(stream.read_block().size(), 10);
+  ASSERT_EQ(stream.remove(12), 12);
+  ASSERT_EQ(stream.read_block().size(), 1998);
+  ASSERT_EQ(stream.push(), 5008);
+  ASSERT_TRUE(stream.empty());
+  bytes.clear();
+  bytes.reserve(8192);
+  ASSERT_EQ(peer.recv(bytes), 5008);
+  r = {reinterpret_cast<const char *>(bytes.data()), 5008};
+  ASSERT_EQ(r, shared1.substr(2) + "yyyyy" + shared2 + "small");
+}
+
+namespace {
+
+// The awaitable socket send in place and resolve at once.
+class AwaitableSocket : public socket::Basic {
+
+ public:
+  using socket::Basic::Basic;
+  using socket::Basic::send_await;
+  plain::net::detail::Awaitable send_await(
+    plain::const_byte_span_t bytes, uint32_t flag, void *) override {
+    auto r = send(std::span<const plain::const_byte_span_t>{&bytes, 1}, flag);
+    return plain::net::detail::Awaitable{[r](void *resolver) {
+      static_cast<plain::net::detail::Resolver *>(resolver)->resolve(r);
+    }};
+  }
+  constexpr bool awaitable() const override {
+    return true;
+  }
+
+};
+
+} // namespace
+
+// The awaitable push send the shared(the broadcast) bytes in order too.
+void plain::tests::test_net_stream_push_await() {
+  socket::id_t fds[2]{socket::kInvalidId, socket::kInvalidId};
+#if OS_WIN
+  auto family = AF_INET;
+#else
+  auto family = AF_UNIX;
+#endif
+  ASSERT_EQ(socket::socketpair(family, SOCK_STREAM, 0, fds), 0);
+  auto sock = std::make_shared<AwaitableSocket>(fds[0]);
+  socket::Basic peer{fds[1]};
+  auto stream = stream::Basic{sock};
+  auto shared = std::make_shared<bytes_t>(2000, std::byte{'1'});
+  ASSERT_EQ(stream.write(std::string(10, 'x')), 10);
+  ASSERT_TRUE(stream.write(std::shared_ptr<const bytes_t>{shared}));
+  ASSERT_EQ(stream.write(std::string(5, 'y')), 5);
+  ASSERT_EQ(stream.size(), 2015);
+  auto task = stream.push_await(nullptr);
+  ASSERT_TRUE(task.done());
+  ASSERT_EQ(task.get_result(), 2015);
+  ASSERT_EQ(stream.size(), 0);
+  ASSERT_TRUE(stream.empty());
+  bytes_t bytes;
+  bytes.reserve(4096);
+  ASSERT_EQ(peer.recv(bytes), 2015);
+  std::string_view r{reinterpret_cast<const char *>(bytes.data()), 2015};
+  ASSERT_EQ(r, std::string(10, 'x') + std::string(2000, '1') + "yyyyy");
 }
 
 using namespace plain::tests;
@@ -85,3 +283,15 @@ TEST_F(TStream, testConstructor) {
 TEST_F(TStream, testFunc) {
   test_net_stream_funcs();
 }
+
+TEST_F(TStream, testPull) {
+  test_net_stream_pull();
+}
+
+TEST_F(TStream, testPush) {
+  test_net_stream_push();
+}
+
+TEST_F(TStream, testPushAwait) {
+  test_net_stream_push_await();
+}
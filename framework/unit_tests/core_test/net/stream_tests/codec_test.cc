@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "plain/all.h"
+#include "assertions.h"
+
+using namespace plain::net;
+
+class TCodec : public testing::Test {
+
+ public:
+  static void SetUpTestCase() {
+    //Normal.
+  }
+
+  static void TearDownTestCase() {
+    //std::cout << "TearDownTestCase" << std::endl;
+  }
+
+ public:
+
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+
+};
+
+namespace plain::tests {
+
+  void test_net_codec_encode_to();
+
+}
+
+void plain::tests::test_net_codec_encode_to() {
+  auto sock = std::make_shared<socket::Basic>();
+  auto output = stream::Basic{sock};
+  auto packet = std::make_shared<packet::Basic>();
+  packet->set_id(1);
+  packet->set_writeable(true);
+  *packet << "hello world";
+  packet->set_writeable(false);
+
+  // The contiguous borrowed in place(no copy), the writing while it borrowed
+  // not overwrite it.
+  {
+    ASSERT_TRUE(stream::encode_to(&output, *packet));
+    auto r = stream::decode(&output, {});
+    auto p = std::get_if<std::shared_ptr<packet::Basic>>(&r);
+    ASSERT_TRUE(p != nullptr);
+    ASSERT_EQ((*p)->copied(), 0);
+    ASSERT_TRUE(output.empty());
+    ASSERT_EQ(output.write(std::string(64, 'x')), 64);
+    std::string r_str;
+    *(*p) >> r_str;
+    ASSERT_EQ(r_str, "hello world");
+    ASSERT_EQ((*p)->copied(), 0);
+    output.clear();
+  }
+
+  // Let the ring free space wraps(the default buffer size is 128).
+  std::string str(120, 'a');
+  ASSERT_EQ(output.write(str), 120);
+  str.resize(110);
+  ASSERT_EQ(output.read(str), 110);
+
+  auto bytes = stream::encode(packet);
+  ASSERT_TRUE(stream::encode_to(&output, *packet));
+  ASSERT_EQ(output.size(), 10 + bytes.size());
+  ASSERT_EQ(output.remove(10), 10);
+  bytes_t r_bytes;
+  r_bytes.resize(bytes.size());
+  output.peek(r_bytes.data(), r_bytes.size());
+  ASSERT_EQ(r_bytes, bytes);
+
+  auto r = stream::decode(&output, {});
+  auto p = std::get_if<std::shared_ptr<packet::Basic>>(&r);
+  ASSERT_TRUE(p != nullptr);
+  ASSERT_EQ((*p)->id(), 1);
+  std::string r_str;
+  *(*p) >> r_str;
+  ASSERT_EQ(r_str, "hello world");
+  ASSERT_TRUE(output.empty());
+  // The wrapped copied to the slab and counted.
+  ASSERT_EQ((*p)->copied(), packet->data().size());
+
+  // Writing to a borrowed packet copies the data once.
+  (*p)->set_writeable(true);
+  *(*p) << 1;
+  ASSERT_EQ((*p)->copied(), packet->data().size() * 2 + sizeof(int32_t));
+  ASSERT_EQ((*p)->data().size(), packet->data().size() + sizeof(int32_t));
+
+  packet->set_call_request(true);
+  bytes = stream::line_encode(packet);
+  ASSERT_TRUE(stream::line_encode_to(&output, *packet));
+  ASSERT_EQ(output.size(), bytes.size());
+  r_bytes.resize(bytes.size());
+  output.read(r_bytes.data(), r_bytes.size());
+  ASSERT_EQ(r_bytes, bytes);
+}
+
+using namespace plain::tests;
+
+TEST_F(TCodec, testEncodeTo) {
+  test_net_codec_encode_to();
+}
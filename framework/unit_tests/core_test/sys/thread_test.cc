@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "plain/all.h"
+
+class TThread : public testing::Test {
+
+ public:
+   static void SetUpTestCase() {
+     //Normal.
+   }
+
+   static void TearDownTestCase() {
+     //std::cout << "TearDownTestCase" << std::endl;
+   }
+
+ public:
+
+   virtual void SetUp() {
+   }
+
+   virtual void TearDown() {
+   }
+
+};
+
+void thread_affinity() {
+  auto cpus = plain::thread::get_affinity();
+  ASSERT_FALSE(cpus.empty());
+  std::thread([cpu = cpus.back()] {
+    ASSERT_TRUE(plain::thread::set_affinity({cpu}));
+    ASSERT_EQ(plain::thread::get_affinity(), std::vector<int32_t>{cpu});
+    ASSERT_GE(plain::thread::numa_node(cpu), -1); // Unknown without numa.
+    ASSERT_FALSE(plain::thread::set_affinity({-1}));
+    ASSERT_FALSE(plain::thread::set_affinity({}));
+  }).join();
+  ASSERT_EQ(plain::thread::numa_node(1 << 20), -1);
+}
+
+// The pool workers take the cpus in turn.
+void thread_executor_affinity() {
+  using namespace std::chrono_literals;
+  auto cpus = plain::thread::get_affinity();
+  auto cpu = cpus.front();
+  auto executor = std::make_shared<plain::concurrency::executor::ThreadPool>(
+    "threadpool", 2, std::chrono::seconds(10), nullptr, nullptr,
+    plain::concurrency::wait_policy_t{}, std::vector<int32_t>{cpu});
+  ASSERT_EQ(executor->worker_cpu(0), cpu);
+  ASSERT_EQ(executor->worker_cpu(1), cpu);
+  ASSERT_EQ(executor->worker_cpu(2), -1);
+  std::atomic_int32_t count{0};
+  for (int32_t i = 0; i < 10; ++i) {
+    executor->post([&count, cpu] {
+      if (plain::thread::get_affinity() == std::vector<int32_t>{cpu})
+        ++count;
+    });
+  }
+  for (int32_t i = 0; i < 5000 && count < 10; ++i)
+    std::this_thread::sleep_for(1ms);
+  ASSERT_EQ(count, 10);
+  executor->shutdown();
+
+  auto worker_thread =
+    std::make_shared<plain::concurrency::executor::WorkerThread>(
+      nullptr, nullptr, plain::concurrency::wait_policy_t{},
+      std::vector<int32_t>{cpu});
+  auto r = worker_thread->submit([] {
+    return plain::thread::get_affinity();
+  });
+  ASSERT_EQ(r.get(), std::vector<int32_t>{cpu});
+  worker_thread->shutdown();
+}
+
+TEST_F(TThread, testAffinity) {
+  thread_affinity();
+}
+
+TEST_F(TThread, testExecutorAffinity) {
+  thread_executor_affinity();
+}